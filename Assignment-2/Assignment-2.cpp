@@ -32,12 +32,15 @@ using namespace SVF;
 using namespace SVFUtil;
 
 /// TODO: Implement your context-sensitive ICFG traversal here to traverse each program path (once for any loop) from src edge to dst node
+/// To unroll loops up to the bounds of getBudget(), use visitEdge/unvisitEdge instead of the visited set,
+/// and pushCallStack/popCallStack to update the callstack.
+/// Stop extending the path when canDescend() returns false, and call getBudget().countPath() for each path found
 void ICFGTraversal::dfs(const ICFGEdge *src, const ICFGNode *dst) {
     
 }
 
 /// TODO: print each path once this method is called, and
-/// add each path as a string into std::set<std::string> paths
+/// pass each path to the path consumer by calling consumePath(), which by default collects it as a string into getPaths()
 /// Print the path in the format "START: 1->2->4->5->END", where -> indicate an ICFGEdge connects two ICFGNode IDs
 void ICFGTraversal::printICFGPath()
 {
@@ -45,17 +48,24 @@ void ICFGTraversal::printICFGPath()
 }
 
 /// Program entry, do not change
+/// The sinks left once a budget runs out are not traversed, and the paths collected so far are reported as partial
 void ICFGTraversal::analyse()
 {
     std::set<const ICFGNode *> sources;
     std::set<const ICFGNode *> sinks;
+    budget.start();
     for (const ICFGNode *src : identifySource(sources)) {
         assert(SVFUtil::isa<GlobalICFGNode>(src) && "dfs should start with GlobalICFGNode!");
         for (const ICFGNode *sink: identifySink(sinks)) {
-            const IntraCFGEdge* startEdge = new IntraCFGEdge(nullptr,const_cast<ICFGNode*>(src));
+            if (budget.isExhausted())
+                break;
+            const IntraCFGEdge* startEdge = arena.create<IntraCFGEdge>(nullptr,const_cast<ICFGNode*>(src));
             handleIntra(startEdge);
             dfs(startEdge, sink);
             resetSolver();
         }
     }
+    consumer->finish();
+    if (budget.isPartial())
+        SVFUtil::outs() << SVFUtil::wrnMsg(budget.toString()) << "\n";
 }
\ No newline at end of file
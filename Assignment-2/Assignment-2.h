@@ -30,6 +30,10 @@
 #define SVF_ICFG_TRAVERSAL_H
 
 #include "SVF-LLVM/SVFIRBuilder.h"
+#include "CallingCtxTrie.h"
+#include "ExplorationBudget.h"
+#include "PathConsumer.h"
+#include "PathArena.h"
 
 namespace SVF{
 
@@ -37,8 +41,9 @@ class ICFGTraversal
 {
 public:
     typedef std::vector<const ICFGNode*> CallStack;
+    typedef CallingCtxTrie::CtxID CallStackID;
 
-    ICFGTraversal(SVFIR *s, ICFG *i) : svfir(s), icfg(i)
+    ICFGTraversal(SVFIR *s, ICFG *i) : icfg(i), consumer(&collector), svfir(s), callstackId(CallingCtxTrie::EmptyCtx)
     {
     }
 
@@ -66,14 +71,84 @@ public:
         return (fun != NULL && (fun->getName() == "assert" || fun->getName() == "svf_assert" ||fun->getName() == "sink" ));
     }
 
-    /// clear visited and callstack
+    /// clear visited and callstack, and release the objects of the run (e.g., the start edge)
     virtual void resetSolver(){
         visited.clear();
+        visitCounts.clear();
+        arena.release();
     }        
 
+    /// Call stack of the traversal, pushed and popped together with its interned ID (see CallingCtxTrie)
+    //@{
+    inline void pushCallStack(const ICFGNode *callSite)
+    {
+        callstack.push_back(callSite);
+        callstackId = callStacks.push(callstackId, callSite);
+    }
+    inline void popCallStack()
+    {
+        callstack.pop_back();
+        callstackId = callStacks.pop(callstackId);
+    }
+    //@}
+
+    /// Loop unrolling: take edge under the current callstack, return false if it has already been taken
+    /// as many times on the current path as the unroll bound of its function allows
+    bool visitEdge(const ICFGEdge *edge)
+    {
+        assert(callStacks.getDepth(callstackId) == callstack.size() && "callstack changed without pushCallStack/popCallStack?");
+        u32_t &count = visitCounts[std::make_pair(edge, callstackId)];
+        if (count >= budget.getLoopUnrollBound(edge->getSrcNode()->getFun()))
+            return false;
+        count++;
+        return true;
+    }
+
+    /// Undo visitEdge when edge is removed from the path
+    void unvisitEdge(const ICFGEdge *edge)
+    {
+        auto it = visitCounts.find(std::make_pair(edge, callstackId));
+        assert(it != visitCounts.end() && "unvisitEdge without visitEdge?");
+        if (--it->second == 0)
+            visitCounts.erase(it);
+    }
+
+    /// Return false if dfs must not extend the current path (a budget ran out, or the path is at the depth bound)
+    inline bool canDescend()
+    {
+        return budget.canDescend(path.size());
+    }
+
+    /// Loop unrolling bounds and budgets of analyse
+    inline ExplorationBudget &getBudget()
+    {
+        return budget;
+    }
+
     /// Print the ICFG path
     virtual void printICFGPath();
 
+    /// Paths found by dfs
+    //@{
+    /// Stream the paths to c (owned by the caller) instead of collecting them, nullptr restores the PathSetCollector
+    inline void setPathConsumer(PathConsumer *c)
+    {
+        consumer = c ? c : &collector;
+    }
+    inline PathConsumer *getPathConsumer() const
+    {
+        return consumer;
+    }
+    /// Pass the current path to the consumer, as the IDs of the destination nodes of its edges
+    void consumePath()
+    {
+        nodeBuffer.clear();
+        for (const ICFGEdge *edge : path)
+            nodeBuffer.push_back(edge->getDstNode()->getId());
+        consumer->consume(nodeBuffer.data(), nodeBuffer.size());
+    }
+    //@}
+
     /// Depth-first-search ICFGTraversal on ICFG from src edge to dst node
     void dfs(const ICFGEdge *src, const ICFGNode *dst);
 
@@ -83,18 +158,27 @@ public:
     virtual bool handleRet(const RetCFGEdge* ret) {  return true; }
     virtual bool handleIntra(const IntraCFGEdge* edge) {  return true; }
     
-    Set<std::string> getPaths(){
-        return paths;
+    /// Paths collected by the default consumer (empty while another consumer is set)
+    const Set<std::string> &getPaths() const
+    {
+        return collector.getPaths();
     }
 private:
     ICFG *icfg;
-    Set<std::string> paths;
+    PathSetCollector collector;
+    PathConsumer *consumer;
+    std::vector<NodeID> nodeBuffer;  ///< node IDs of the path being consumed
 
 protected:
     SVFIR *svfir;
     Set<std::pair<const ICFGEdge *, CallStack > > visited;
+    Map<std::pair<const ICFGEdge *, CallStackID>, u32_t> visitCounts;  ///< times each (edge, callstack) is on the current path
+    ExplorationBudget budget;
     CallStack callstack;
+    CallStackID callstackId;  ///< interned callstack
+    CallingCtxTrie callStacks;
     std::vector<const ICFGEdge *> path;
+    PathArena arena;  ///< objects of the current run, released by resetSolver
 };
 }
 
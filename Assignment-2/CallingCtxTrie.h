@@ -0,0 +1,112 @@
+//===- CallingCtxTrie.h -- Interned calling contexts ------------------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Interned calling contexts
+ *
+ * A calling context (a stack of call sites) is a node of a trie of call sites and is
+ * identified by the dense ID of that node. The empty context is the root (ID 0).
+ * Pushing a call site moves to a child node and popping moves to the parent node,
+ * so contexts can be hashed, compared and copied as a single integer.
+ * Used for the call stacks of the path-based traversals (ICFGTraversal, SSE) and the calling contexts of SSE.
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_CALLINGCTXTRIE_H
+#define SOFTWARE_SECURITY_ANALYSIS_CALLINGCTXTRIE_H
+
+#include "SVFIR/SVFIR.h"
+
+namespace SVF {
+
+	class CallingCtxTrie {
+	 public:
+		typedef u32_t CtxID;
+		typedef std::vector<const ICFGNode*> CallStack;
+
+		/// ID of the empty calling context
+		static const CtxID EmptyCtx = 0;
+
+		CallingCtxTrie() {
+			nodes.push_back(CtxNode{nullptr, EmptyCtx, 0});
+		}
+
+		/// Return the context of ctx extended with callSite, the trie node is created on first use
+		inline CtxID push(CtxID ctx, const ICFGNode* callSite) {
+			std::pair<CtxID, const ICFGNode*> key(ctx, callSite);
+			auto it = children.find(key);
+			if (it != children.end())
+				return it->second;
+			CtxID child = nodes.size();
+			nodes.push_back(CtxNode{callSite, ctx, nodes[ctx].depth + 1});
+			children.emplace(key, child);
+			return child;
+		}
+
+		/// Return the context of ctx without its last call site
+		inline CtxID pop(CtxID ctx) const {
+			assert(ctx != EmptyCtx && "pop an empty calling context?");
+			return nodes[ctx].parent;
+		}
+
+		/// Return the last call site of ctx
+		inline const ICFGNode* getCallSite(CtxID ctx) const {
+			return nodes[ctx].callSite;
+		}
+
+		inline u32_t getDepth(CtxID ctx) const {
+			return nodes[ctx].depth;
+		}
+
+		/// Intern a call stack (outermost call site first)
+		inline CtxID getCtxID(const CallStack& callStack) {
+			CtxID ctx = EmptyCtx;
+			for (const ICFGNode* callSite : callStack)
+				ctx = push(ctx, callSite);
+			return ctx;
+		}
+
+		/// Return the call stack of ctx (outermost call site first)
+		inline CallStack getCallStack(CtxID ctx) const {
+			CallStack callStack(nodes[ctx].depth);
+			for (; ctx != EmptyCtx; ctx = nodes[ctx].parent)
+				callStack[nodes[ctx].depth - 1] = nodes[ctx].callSite;
+			return callStack;
+		}
+
+		/// Number of interned contexts
+		inline u32_t size() const {
+			return nodes.size();
+		}
+
+	 private:
+		struct CtxNode {
+			const ICFGNode* callSite;
+			CtxID parent;
+			u32_t depth;
+		};
+
+		std::vector<CtxNode> nodes;
+		Map<std::pair<CtxID, const ICFGNode*>, CtxID> children;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_CALLINGCTXTRIE_H
@@ -0,0 +1,224 @@
+//===- Software-Verification-Teaching Assignment 2-------------------------------------//
+//
+//     SVF: Static Value-Flow Analysis Framework for Source Code
+//
+// Copyright (C) <2013->
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===-----------------------------------------------------------------------===//
+
+/*
+ // Loop unrolling bounds and exploration budgets of the path-based traversals (ICFGTraversal, SSE)
+ //
+ // A loop is unrolled by allowing each (edge, call stack) pair to be taken up to the unroll bound
+ // of the function containing the edge on one path (the default bound 1 follows each loop once).
+ // SSE translates each iteration with fresh symbols for the values it redefines.
+ // Budgets limit a whole analyse run: the number of paths, the solver time and the wall time; the
+ // depth budget limits the length of each path. 0 means unbounded. Once a budget runs out, the
+ // traversal stops descending and the results gathered so far are reported as partial.
+ */
+
+#ifndef SVF_EXPLORATION_BUDGET_H
+#define SVF_EXPLORATION_BUDGET_H
+
+#include "SVFIR/SVFIR.h"
+#include <chrono>
+#include <sstream>
+
+namespace SVF{
+
+class ExplorationBudget
+{
+public:
+    /// The budget that ran out first
+    enum Exhaustion
+    {
+        NotExhausted,
+        PathBudget,
+        SolverTimeBudget,
+        WallTimeBudget
+    };
+
+    ExplorationBudget() : defaultUnrollBound(1), maxPaths(0), maxDepth(0), maxSolverMs(0), maxWallMs(0)
+    {
+        start();
+    }
+
+    /// Loop unrolling bounds
+    //@{
+    inline void setLoopUnrollBound(u32_t bound)
+    {
+        assert(bound > 0 && "a loop unroll bound of 0 would forbid any edge");
+        defaultUnrollBound = bound;
+    }
+    /// Override the bound for the loops of one function
+    inline void setLoopUnrollBound(const std::string& funName, u32_t bound)
+    {
+        assert(bound > 0 && "a loop unroll bound of 0 would forbid any edge");
+        funUnrollBounds[funName] = bound;
+    }
+    /// Bound of the loops of fun (nullptr for the global ICFGNode)
+    inline u32_t getLoopUnrollBound(const FunObjVar* fun) const
+    {
+        if (fun != nullptr)
+        {
+            auto it = funUnrollBounds.find(fun->getName());
+            if (it != funUnrollBounds.end())
+                return it->second;
+        }
+        return defaultUnrollBound;
+    }
+    //@}
+
+    /// Budgets, 0 means unbounded
+    //@{
+    inline void setMaxPaths(u32_t paths)
+    {
+        maxPaths = paths;
+    }
+    inline void setMaxDepth(u32_t depth)
+    {
+        maxDepth = depth;
+    }
+    inline void setMaxSolverTime(u32_t ms)
+    {
+        maxSolverMs = ms;
+    }
+    inline void setMaxWallTime(u32_t ms)
+    {
+        maxWallMs = ms;
+    }
+    //@}
+
+    /// Start a run: reset the counters and the wall clock
+    inline void start()
+    {
+        startTime = std::chrono::steady_clock::now();
+        exhaustion = NotExhausted;
+        paths = 0;
+        truncatedPaths = 0;
+        solverMs = 0;
+    }
+
+    /// Count a complete path (from the source to a sink)
+    inline void countPath()
+    {
+        paths++;
+    }
+
+    /// Account the time of a solver query
+    inline void addSolverTime(double ms)
+    {
+        solverMs += ms;
+    }
+
+    /// Return true if a run budget ran out, once out it stays out until the next start
+    inline bool isExhausted()
+    {
+        if (exhaustion != NotExhausted)
+            return true;
+        if (maxPaths > 0 && paths >= maxPaths)
+            exhaustion = PathBudget;
+        else if (maxSolverMs > 0 && solverMs >= maxSolverMs)
+            exhaustion = SolverTimeBudget;
+        else if (maxWallMs > 0 && getWallTime() >= maxWallMs)
+            exhaustion = WallTimeBudget;
+        return exhaustion != NotExhausted;
+    }
+
+    /// Return true if a path of length depth may be extended, a path cut at the depth bound is counted as truncated
+    inline bool canDescend(u32_t depth)
+    {
+        if (isExhausted())
+            return false;
+        if (maxDepth > 0 && depth >= maxDepth)
+        {
+            truncatedPaths++;
+            return false;
+        }
+        return true;
+    }
+
+    /// Return true if the results of the run do not cover every path (within the unroll bounds)
+    inline bool isPartial()
+    {
+        return isExhausted() || truncatedPaths > 0;
+    }
+
+    /// Statistics of the run
+    //@{
+    inline Exhaustion getExhaustion() const
+    {
+        return exhaustion;
+    }
+    inline u32_t getPathNum() const
+    {
+        return paths;
+    }
+    inline u32_t getTruncatedPathNum() const
+    {
+        return truncatedPaths;
+    }
+    inline double getSolverTime() const
+    {
+        return solverMs;
+    }
+    inline double getWallTime() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+    //@}
+
+    /// One-line summary of a partial run
+    std::string toString() const
+    {
+        std::stringstream ss;
+        ss << "Partial results: ";
+        switch (exhaustion)
+        {
+        case PathBudget:
+            ss << "path budget (" << maxPaths << ") exhausted, ";
+            break;
+        case SolverTimeBudget:
+            ss << "solver time budget (" << maxSolverMs << " ms) exhausted, ";
+            break;
+        case WallTimeBudget:
+            ss << "wall time budget (" << maxWallMs << " ms) exhausted, ";
+            break;
+        case NotExhausted:
+            break;
+        }
+        ss << paths << " paths explored, " << truncatedPaths << " paths cut at depth " << maxDepth;
+        return ss.str();
+    }
+
+private:
+    u32_t defaultUnrollBound;
+    Map<std::string, u32_t> funUnrollBounds;
+    u32_t maxPaths;
+    u32_t maxDepth;
+    u32_t maxSolverMs;
+    u32_t maxWallMs;
+
+    std::chrono::steady_clock::time_point startTime;
+    Exhaustion exhaustion;
+    u32_t paths;
+    u32_t truncatedPaths;
+    double solverMs;
+};
+}
+
+#endif //SVF_EXPLORATION_BUDGET_H
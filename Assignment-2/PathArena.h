@@ -0,0 +1,173 @@
+//===- Software-Verification-Teaching Assignment 2-------------------------------------//
+//
+//     SVF: Static Value-Flow Analysis Framework for Source Code
+//
+// Copyright (C) <2013->
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===-----------------------------------------------------------------------===//
+
+/*
+ // Arena of the per-run objects of the path-based traversals (ICFGTraversal, SSE)
+ //
+ // Objects living until the end of a run (synthetic start edges, path nodes of the pending states of
+ // the exploration) are bump-allocated from large chunks and released all at once by release(), which
+ // the traversals call from resetSolver(). The chunks are kept for the next run, so a traversal does
+ // not call malloc/free in its inner loop once warmed up. Paths are stored as lists of 32-bit edge IDs
+ // sharing their prefixes, the edges being numbered per run by the arena.
+ */
+
+#ifndef SVF_PATH_ARENA_H
+#define SVF_PATH_ARENA_H
+
+#include "SVFIR/SVFIR.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace SVF{
+
+class PathArena
+{
+public:
+    /// A path as a list from its last edge back to its first, so paths sharing a prefix share its nodes
+    struct PathNode
+    {
+        const PathNode *prev;  ///< nullptr for the first edge
+        u32_t edge;            ///< edge ID
+        u32_t depth;           ///< number of edges up to and including this one
+    };
+
+    PathArena(u32_t chunkBytes = 1 << 16) : chunkSize(chunkBytes), current(0), offset(0), allocated(0)
+    {
+    }
+
+    ~PathArena()
+    {
+        release();
+    }
+
+    PathArena(const PathArena &) = delete;
+    PathArena &operator=(const PathArena &) = delete;
+
+    /// Uninitialized memory for size bytes aligned to align, valid until release
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        assert(align <= alignof(std::max_align_t) && "over-aligned arena allocation");
+        offset = (offset + align - 1) & ~(align - 1);
+        if (chunks.empty() || offset + size > chunkCapacity(current))
+            nextChunk(size);
+        void *p = chunks[current].get() + offset;
+        offset += size;
+        allocated += size;
+        return p;
+    }
+
+    /// Construct a T in the arena, its destructor (if any) runs on release
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        T *obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value)
+            destructors.emplace_back(obj, [](void *o) { static_cast<T *>(o)->~T(); });
+        return obj;
+    }
+
+    /// ID of edge in this run, edges are numbered in the order they are first seen
+    inline u32_t getEdgeId(const ICFGEdge *edge)
+    {
+        auto it = edgeIds.emplace(edge, edges.size());
+        if (it.second)
+            edges.push_back(edge);
+        return it.first->second;
+    }
+    inline const ICFGEdge *getEdge(u32_t id) const
+    {
+        assert(id < edges.size() && "edge ID of another run?");
+        return edges[id];
+    }
+
+    /// Path prev followed by edge
+    inline const PathNode *extend(const PathNode *prev, const ICFGEdge *edge)
+    {
+        return create<PathNode>(PathNode{prev, getEdgeId(edge), prev ? prev->depth + 1 : 1});
+    }
+
+    /// Edges of the path ending with tail, in path order
+    void getPath(const PathNode *tail, std::vector<const ICFGEdge *> &path) const
+    {
+        path.resize(tail ? tail->depth : 0);
+        for (const PathNode *n = tail; n; n = n->prev)
+            path[n->depth - 1] = getEdge(n->edge);
+    }
+
+    /// Destroy the objects and forget the edge IDs of the run, the chunks are kept for the next run
+    void release()
+    {
+        for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+            it->second(it->first);
+        destructors.clear();
+        edgeIds.clear();
+        edges.clear();
+        current = 0;
+        offset = 0;
+        allocated = 0;
+    }
+
+    /// Bytes handed out since the last release
+    inline size_t getAllocatedBytes() const
+    {
+        return allocated;
+    }
+
+private:
+    inline size_t chunkCapacity(u32_t idx) const
+    {
+        return capacities[idx];
+    }
+
+    /// Move to the next chunk able to hold size bytes, allocating it if needed
+    void nextChunk(size_t size)
+    {
+        if (!chunks.empty())
+            current++;
+        while (current < chunks.size() && chunkCapacity(current) < size)
+            current++;
+        if (current >= chunks.size())
+        {
+            size_t capacity = std::max<size_t>(chunkSize, size);
+            chunks.emplace_back(new char[capacity]);
+            capacities.push_back(capacity);
+            current = chunks.size() - 1;
+        }
+        offset = 0;
+    }
+
+    size_t chunkSize;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    std::vector<size_t> capacities;
+    u32_t current;  ///< chunk being filled
+    size_t offset;  ///< next free byte of the current chunk
+    size_t allocated;
+    std::vector<std::pair<void *, void (*)(void *)>> destructors;
+    Map<const ICFGEdge *, u32_t> edgeIds;
+    std::vector<const ICFGEdge *> edges;  ///< edge ID -> edge
+};
+}
+
+#endif //SVF_PATH_ARENA_H
@@ -0,0 +1,201 @@
+//===- Software-Verification-Teaching Assignment 2-------------------------------------//
+//
+//     SVF: Static Value-Flow Analysis Framework for Source Code
+//
+// Copyright (C) <2013->
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===-----------------------------------------------------------------------===//
+
+/*
+ // Consumers of the paths found by the path-based traversals (ICFGTraversal, SSE)
+ //
+ // A path is streamed to the consumer as the span of the IDs of its ICFGNodes, from the source to the
+ // sink, which is only valid during the call. The default PathSetCollector keeps every path as a
+ // "START: 1->2->4->5->END" string (what getPaths returns); the other consumers run in constant memory
+ // (PathSampler in memory bounded by its sample size) however many paths there are.
+ */
+
+#ifndef SVF_PATH_CONSUMER_H
+#define SVF_PATH_CONSUMER_H
+
+#include "SVFIR/SVFIR.h"
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace SVF{
+
+class PathConsumer
+{
+public:
+    virtual ~PathConsumer()
+    {
+    }
+
+    /// Receive one path of size ICFGNode IDs
+    virtual void consume(const NodeID *nodes, u32_t size) = 0;
+
+    /// Called once the traversal is over, e.g., to flush buffered output
+    virtual void finish()
+    {
+    }
+
+    /// Format a path as "START: 1->2->4->5->END"
+    static std::string toString(const NodeID *nodes, u32_t size)
+    {
+        std::stringstream ss;
+        ss << "START: ";
+        for (u32_t i = 0; i < size; i++)
+            ss << nodes[i] << "->";
+        ss << "END";
+        return ss.str();
+    }
+};
+
+/// Keep every path as a string (the default consumer)
+class PathSetCollector : public PathConsumer
+{
+public:
+    virtual void consume(const NodeID *nodes, u32_t size) override
+    {
+        paths.insert(toString(nodes, size));
+    }
+    inline const Set<std::string> &getPaths() const
+    {
+        return paths;
+    }
+    inline void clear()
+    {
+        paths.clear();
+    }
+
+private:
+    Set<std::string> paths;
+};
+
+/// Count the paths and their total length
+class PathCounter : public PathConsumer
+{
+public:
+    PathCounter() : paths(0), nodes(0)
+    {
+    }
+    virtual void consume(const NodeID *, u32_t size) override
+    {
+        paths++;
+        nodes += size;
+    }
+    inline u64_t getPathNum() const
+    {
+        return paths;
+    }
+    inline u64_t getNodeNum() const
+    {
+        return nodes;
+    }
+
+private:
+    u64_t paths;
+    u64_t nodes;
+};
+
+/// Uniform sample of at most k paths (reservoir sampling)
+class PathSampler : public PathConsumer
+{
+public:
+    PathSampler(u32_t k, u32_t seed = 0) : capacity(k), seen(0), rng(seed)
+    {
+    }
+    virtual void consume(const NodeID *nodes, u32_t size) override
+    {
+        seen++;
+        if (sample.size() < capacity)
+        {
+            sample.emplace_back(nodes, nodes + size);
+            return;
+        }
+        std::uniform_int_distribution<u64_t> pick(0, seen - 1);
+        u64_t slot = pick(rng);
+        if (slot < capacity)
+            sample[slot].assign(nodes, nodes + size);
+    }
+    inline const std::vector<std::vector<NodeID>> &getSample() const
+    {
+        return sample;
+    }
+    /// Number of paths the sample was drawn from
+    inline u64_t getSeenNum() const
+    {
+        return seen;
+    }
+
+private:
+    u32_t capacity;
+    u64_t seen;
+    std::mt19937_64 rng;
+    std::vector<std::vector<NodeID>> sample;
+};
+
+/// Write each path as a "START: 1->2->4->5->END" line
+class PathTextWriter : public PathConsumer
+{
+public:
+    PathTextWriter(std::ostream &o) : out(o)
+    {
+    }
+    virtual void consume(const NodeID *nodes, u32_t size) override
+    {
+        out << "START: ";
+        for (u32_t i = 0; i < size; i++)
+            out << nodes[i] << "->";
+        out << "END\n";
+    }
+    virtual void finish() override
+    {
+        out.flush();
+    }
+
+private:
+    std::ostream &out;
+};
+
+/// Write each path as its size followed by its node IDs, all as 32-bit words in host byte order
+class PathBinaryWriter : public PathConsumer
+{
+    static_assert(sizeof(NodeID) == sizeof(u32_t), "node IDs are written as 32-bit words");
+
+public:
+    PathBinaryWriter(const std::string &fileName) : out(fileName, std::ios::binary | std::ios::trunc)
+    {
+        assert(out && "cannot open the path file");
+    }
+    virtual void consume(const NodeID *nodes, u32_t size) override
+    {
+        out.write(reinterpret_cast<const char *>(&size), sizeof(u32_t));
+        out.write(reinterpret_cast<const char *>(nodes), size * sizeof(NodeID));
+    }
+    virtual void finish() override
+    {
+        out.flush();
+    }
+
+private:
+    std::ofstream out;
+};
+}
+
+#endif //SVF_PATH_CONSUMER_H
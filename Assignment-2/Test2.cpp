@@ -131,6 +131,82 @@ int test3()
     return 0;
 }
 
+/// The paths of test3 streamed to a PathCounter and to a PathSampler instead of being collected
+int test4()
+{
+    std::vector<std::string> moduleNameVec = { "./Assignment-2/testcase/bc/test3.ll"};
+
+    LLVMModuleSet::getLLVMModuleSet()->buildSVFModule(moduleNameVec);
+
+    SVFIRBuilder builder;
+    SVFIR *svfir = builder.build();
+
+    CallGraph* callgraph = AndersenWaveDiff::createAndersenWaveDiff(svfir)->getCallGraph();
+    builder.updateCallGraph(callgraph);
+
+    /// ICFG
+    ICFG *icfg = svfir->getICFG();
+    icfg->updateCallGraph(callgraph);
+
+    ICFGTraversal *traversal = new ICFGTraversal(svfir, icfg);
+    PathCounter counter;
+    traversal->setPathConsumer(&counter);
+    traversal->analyse();
+    assert(counter.getPathNum() == 2 && counter.getNodeNum() == 19 && traversal->getPaths().empty() && "test4 failed!");
+
+    PathSampler sampler(1);
+    traversal->setPathConsumer(&sampler);
+    traversal->analyse();
+    Set<std::string> expected = {"START: 0->3->19->1->5->6->8->10->12->END", "START: 0->3->19->1->5->6->7->9->11->14->END"};
+    const std::vector<NodeID> &sample = sampler.getSample().at(0);
+    assert(sampler.getSeenNum() == 2 && sampler.getSample().size() == 1 && "test4 failed!");
+    assert(expected.count(PathConsumer::toString(sample.data(), sample.size())) && "test4 failed!");
+    std::cout << SVFUtil::sucMsg("test4 passed!") << std::endl;
+    SVF::LLVMModuleSet::releaseLLVMModuleSet();
+    SVF::SVFIR::releaseSVFIR();
+    NodeIDAllocator::unset();
+
+    delete traversal;
+    return 0;
+}
+
+/// A PathArena reuses its chunks after release: the next run gets the same memory and numbers its edges from 0
+int test5()
+{
+    struct Counted
+    {
+        u32_t *destroyed;
+        Counted(u32_t *d) : destroyed(d)
+        {
+        }
+        ~Counted()
+        {
+            (*destroyed)++;
+        }
+    };
+    u32_t destroyed = 0;
+    const IntraCFGEdge first(nullptr, nullptr);
+    const IntraCFGEdge second(nullptr, nullptr);
+    PathArena arena(256);
+
+    const PathArena::PathNode *head = arena.extend(nullptr, &first);
+    const PathArena::PathNode *tail = arena.extend(head, &second);
+    std::vector<const ICFGEdge *> path;
+    arena.getPath(tail, path);
+    assert(path.size() == 2 && path[0] == &first && path[1] == &second && tail->edge == 1 && "test5 failed!");
+    void *large = arena.allocate(1024);
+    arena.create<Counted>(&destroyed);
+    assert(destroyed == 0 && arena.getAllocatedBytes() >= 1024 + 2 * sizeof(PathArena::PathNode) && "test5 failed!");
+
+    arena.release();
+    assert(destroyed == 1 && arena.getAllocatedBytes() == 0 && "test5 failed!");
+    const PathArena::PathNode *reused = arena.extend(nullptr, &second);
+    assert(reused == head && reused->edge == 0 && arena.getEdge(0) == &second && "test5 failed!");
+    assert(arena.allocate(1024) == large && "test5 failed!");
+    std::cout << SVFUtil::sucMsg("test5 passed!") << std::endl;
+    return 0;
+}
+
 /*
  // Software-Verification-Teaching Assignment 2 main function entry
  // To run your testcase, please set the "program": "${workspaceFolder}/bin/assign-2" in file '.vscode/launch.json'
@@ -158,4 +234,6 @@ int main(int argc, char **argv)
     test1();
     test2();
     test3();
+    test4();
+    test5();
 }
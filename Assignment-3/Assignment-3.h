@@ -37,7 +37,7 @@ namespace SVF {
     class Z3Examples : public Z3Mgr {
     public:
         Z3Examples(u32_t max)
-                : Z3Mgr(max)
+                : Z3Mgr(max, IntDomain)
                 , maxNumOfExpr(max)
                 , currentExprIdx(0) {}
 
@@ -88,11 +88,11 @@ namespace SVF {
         }
 
         void addToSolver(z3::expr e) {
-            solver.add(e);
+            Z3Mgr::addToSolver(e);
         }
 
         void resetSolver() {
-            solver.reset();
+            Z3Mgr::resetSolver();
             strToIDMap.clear();
             currentExprIdx = 0;
             clearVarID2ExprMap();
@@ -101,10 +101,15 @@ namespace SVF {
         void printExprValues() {
             std::cout.flags(std::ios::left);
             std::cout << "-----------Var and Value-----------\n";
-            for (auto nIter = strToIDMap.begin(); nIter != strToIDMap.end(); nIter++) {
-                z3::expr e = Z3Mgr::getEvalExpr(Z3Mgr::getZ3Expr(nIter->second));
-                if (e.is_numeral()) {
-                    s32_t value = e.get_numeral_int64();
+            z3::expr_vector exprs(ctx);
+            for (auto nIter = strToIDMap.begin(); nIter != strToIDMap.end(); nIter++)
+                exprs.push_back(Z3Mgr::getZ3Expr(nIter->second));
+            Z3EvalTable table;
+            Z3Mgr::evalAll(exprs, table);
+            u32_t i = 0;
+            for (auto nIter = strToIDMap.begin(); nIter != strToIDMap.end(); nIter++, i++) {
+                if (table[i].isNumeral) {
+                    s32_t value = table[i].value;
                     std::stringstream exprName;
                     exprName << "Var" << nIter->second << " (" << nIter->first << ")";
                     std::cout << std::setw(25) << exprName.str();
@@ -45,6 +45,126 @@ bool checkNegateAssert(Z3Examples* z3Mgr, z3::expr q) {
     return res;
 }
 
+// The feasibility cache decides a repeated query, and a query containing a cached unsat one,
+// but no longer a query whose constraints were popped
+bool testFeasibilityCache(Z3Mgr* z3Mgr) {
+    const Z3FeasibilityCache& cache = z3Mgr->getFeasibilityCache();
+    z3::expr x = z3Mgr->getZ3Const("fc_x");
+    z3::expr lit = x > z3Mgr->getZ3Val(5);
+    Z3Mgr::CheckResult res;
+
+    z3Mgr->pushSolver();
+    z3Mgr->addToSolver(x == z3Mgr->getZ3Val(3));
+    u32_t misses = cache.getMissNum();
+    bool miss = !z3Mgr->lookupFeasibility(lit, res) && cache.getMissNum() == misses + 1;
+    z3Mgr->pushSolver();
+    z3Mgr->addToSolver(lit);
+    z3Mgr->recordFeasibility(lit, z3Mgr->checkSolver());
+    z3Mgr->popSolver();
+    bool hit = z3Mgr->lookupFeasibility(lit, res) && res == Z3Mgr::Unsat && cache.getExactHitNum() == 1;
+    z3Mgr->addToSolver(x < z3Mgr->getZ3Val(10));
+    bool subset = z3Mgr->lookupFeasibility(lit, res) && res == Z3Mgr::Unsat && cache.getSubsetHitNum() == 1;
+    z3Mgr->popSolver();
+    bool afterPop = !z3Mgr->lookupFeasibility(lit, res);
+
+    /// only the most recent entries of a literal are scanned for a subset hit
+    Z3FeasibilityCache capped(16, 1);
+    std::vector<z3::expr> unsatPath{x == z3Mgr->getZ3Val(3)};
+    std::vector<z3::expr> satPath{x == z3Mgr->getZ3Val(7)};
+    std::vector<z3::expr> longerPath{x == z3Mgr->getZ3Val(3), x < z3Mgr->getZ3Val(10)};
+    Z3FeasibilityCache::ConstraintSet query;
+    capped.makeQuery(unsatPath, lit, query);
+    capped.insert(query, unsatPath, lit, false);
+    capped.makeQuery(satPath, lit, query);
+    capped.insert(query, satPath, lit, true);
+    capped.makeQuery(longerPath, lit, query);
+    bool sat;
+    bool scanCapped = !capped.lookup(query, lit, sat) && capped.getMissNum() == 1;
+    return miss && hit && subset && afterPop && scanCapped;
+}
+
+// A conflict learned from an infeasible check refutes its constraints again, until they are popped
+bool testConflictDB(Z3Mgr* z3Mgr) {
+    z3::expr x = z3Mgr->getZ3Const("cd_x");
+    z3::expr lit = x > z3Mgr->getZ3Val(5);
+    z3Mgr->setConflictLearning(true);
+
+    z3Mgr->pushSolver();
+    z3Mgr->beginConstraintGroup();
+    z3Mgr->addToSolver(x == z3Mgr->getZ3Val(3));
+    bool noConflict = !z3Mgr->endConstraintGroup();
+    z3Mgr->pushSolver();
+    z3Mgr->beginConstraintGroup();
+    z3Mgr->addToSolver(lit);
+    z3Mgr->endConstraintGroup();
+    bool learned = z3Mgr->checkSolver() == Z3Mgr::Unsat && z3Mgr->getConflictDB().getConflictNum() == 1;
+    z3Mgr->popSolver();
+    bool conflicting = z3Mgr->isConflicting(lit);
+    z3Mgr->pushSolver();
+    z3Mgr->beginConstraintGroup();
+    z3Mgr->addToSolver(lit);
+    bool completed = z3Mgr->endConstraintGroup();
+    z3Mgr->popSolver();
+    z3Mgr->popSolver();
+    bool afterPop = !z3Mgr->isConflicting(lit);
+
+    z3Mgr->setConflictLearning(false);
+
+    /// a conflict is recorded once, whatever the order of its constraints
+    Z3ConflictDB db;
+    db.insert({lit, x == z3Mgr->getZ3Val(3)});
+    db.insert({x == z3Mgr->getZ3Val(3), lit});
+    bool dedup = db.getConflictNum() == 1;
+    db.insert({lit});
+    dedup = dedup && db.getConflictNum() == 2;
+    return noConflict && learned && conflicting && completed && afterPop && dedup && z3Mgr->getConflictDB().getHitNum() == 2;
+}
+
+// A query with independence splitting only solves the component of its literal, is answered from the
+// feasibility cache when repeated, and no longer sees the constraints linking two components once popped
+bool testConstraintPartition(Z3Mgr* z3Mgr) {
+    z3::expr x = z3Mgr->getZ3Const("cp_x");
+    z3::expr y = z3Mgr->getZ3Const("cp_y");
+    z3Mgr->setIndependenceSplitting(true);
+
+    z3Mgr->pushSolver();
+    z3Mgr->addToSolver(x == z3Mgr->getZ3Val(3));
+    z3Mgr->addToSolver(y == z3Mgr->getZ3Val(4));
+    bool miss = z3Mgr->checkIndependent(x > z3Mgr->getZ3Val(5)) == Z3Mgr::Unsat
+                && z3Mgr->getIndependentQueryNum() == 1 && z3Mgr->getDroppedConstraintNum() == 1;
+    bool hit = z3Mgr->checkIndependent(x > z3Mgr->getZ3Val(5)) == Z3Mgr::Unsat && z3Mgr->getIndependentQueryNum() == 1;
+    z3Mgr->pushSolver();
+    z3Mgr->addToSolver(y == x);
+    bool joined = z3Mgr->checkIndependent(y > z3Mgr->getZ3Val(3)) == Z3Mgr::Unsat && z3Mgr->getDroppedConstraintNum() == 1;
+    z3Mgr->popSolver();
+    bool afterPop = z3Mgr->checkIndependent(y > z3Mgr->getZ3Val(3)) == Z3Mgr::Sat && z3Mgr->getDroppedConstraintNum() == 2;
+    z3Mgr->popSolver();
+
+    z3Mgr->setIndependenceSplitting(false);
+    return miss && hit && joined && afterPop && z3Mgr->getIndependentQueryNum() == 3;
+}
+
+// A query satisfied by the model of an earlier query, or containing the unsat core of one, is not solved,
+// and a core no longer refutes a query once its constraints are popped
+bool testModelCache(Z3Mgr* z3Mgr) {
+    const Z3ModelCache& cache = z3Mgr->getModelCache();
+    z3::expr x = z3Mgr->getZ3Const("mc_x");
+    z3::expr lit = x > z3Mgr->getZ3Val(5);
+    z3Mgr->setModelCaching(true);
+
+    z3Mgr->pushSolver();
+    z3Mgr->addToSolver(x == z3Mgr->getZ3Val(3));
+    bool miss = z3Mgr->checkIndependent(x < z3Mgr->getZ3Val(5), false) == Z3Mgr::Sat && cache.getMissNum() == 1;
+    bool modelHit = z3Mgr->checkIndependent(x < z3Mgr->getZ3Val(6), false) == Z3Mgr::Sat && cache.getModelHitNum() == 1;
+    bool refuted = z3Mgr->checkIndependent(lit, false) == Z3Mgr::Unsat && cache.getCoreNum() == 1;
+    bool coreHit = z3Mgr->checkIndependent(lit, false) == Z3Mgr::Unsat && cache.getCoreHitNum() == 1;
+    z3Mgr->popSolver();
+    bool afterPop = z3Mgr->checkIndependent(lit, false) == Z3Mgr::Sat && cache.getCoreHitNum() == 1;
+
+    z3Mgr->setModelCaching(false);
+    return miss && modelHit && refuted && coreHit && afterPop && cache.getMissNum() == 3;
+}
+
 /*
  // Please set the "program": "${workspaceFolder}/bin/lab2" in file '.vscode/launch.json'
  // To run your testcase from 1-10, please set the string number for "args" in file'.vscode/launch.json'
@@ -151,6 +271,18 @@ int main(int argc, char** argv) {
         bool res2 = z3Mgr->hasZ3Expr("x") && z3Mgr->z3Expr2NumValue(z3Mgr->getZ3Expr("x")) == 3;
         result = res1 && res2;
     }
+    else if (test_name == "feasibility-cache") {
+        result = testFeasibilityCache(z3Mgr);
+    }
+    else if (test_name == "conflict-db") {
+        result = testConflictDB(z3Mgr);
+    }
+    else if (test_name == "constraint-partition") {
+        result = testConstraintPartition(z3Mgr);
+    }
+    else if (test_name == "model-cache") {
+        result = testModelCache(z3Mgr);
+    }
     else {
         std::cerr << "Invalid test name" << std::endl;
         return 1;
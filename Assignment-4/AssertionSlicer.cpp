@@ -0,0 +1,182 @@
+//===- AssertionSlicer.cpp -- Assertion-directed backward slicing for SSE ------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Assertion-directed backward slicing for SSE
+ */
+
+#include "AssertionSlicer.h"
+
+using namespace SVF;
+using namespace SVFUtil;
+
+/// StoreStmt is tested first, its LHS is the pointer and not a var it defines
+bool AssertionSlice::isRelevant(const SVFStmt* stmt) const {
+	if (SVFUtil::isa<StoreStmt>(stmt))
+		return memory;
+	else if (const AssignStmt* assign = SVFUtil::dyn_cast<AssignStmt>(stmt))
+		return contains(assign->getLHSVarID());
+	else if (const MultiOpndStmt* multi = SVFUtil::dyn_cast<MultiOpndStmt>(stmt))
+		return contains(multi->getResID());
+	return true;
+}
+
+AssertionSlicer::AssertionSlicer(SVFIR* s, ICFG* i)
+: svfir(s)
+, icfg(i) {
+	collectBranches();
+}
+
+void AssertionSlicer::collectBranches() {
+	for (auto it = icfg->begin(); it != icfg->end(); ++it) {
+		for (const ICFGEdge* edge : it->second->getOutEdges()) {
+			const IntraCFGEdge* intra = SVFUtil::dyn_cast<IntraCFGEdge>(edge);
+			if (intra && intra->getCondition()) {
+				branches.push_back(it->second);
+				break;
+			}
+		}
+	}
+}
+
+/// Each var is expanded once, through the statements defining it
+void AssertionSlicer::close(AssertionSlice& slice, std::vector<NodeID>& worklist) {
+	auto add = [&](NodeID id) {
+		if (slice.vars.insert(id).second)
+			worklist.push_back(id);
+	};
+	while (!worklist.empty()) {
+		NodeID id = worklist.back();
+		worklist.pop_back();
+		slice.vars.insert(id);
+		for (const SVFStmt* stmt : svfir->getGNode(id)->getInEdges()) {
+			if (SVFUtil::isa<StoreStmt>(stmt))
+				continue;
+			else if (const GepStmt* gep = SVFUtil::dyn_cast<GepStmt>(stmt)) {
+				add(gep->getRHSVarID());
+				for (const auto& offset : gep->getOffsetVarAndGepTypePairVec())
+					add(offset.first->getId());
+			}
+			else if (const LoadStmt* load = SVFUtil::dyn_cast<LoadStmt>(stmt)) {
+				add(load->getRHSVarID());
+				if (!slice.memory) {
+					slice.memory = true;
+					for (const SVFStmt* s : svfir->getSVFStmtSet(SVFStmt::Store)) {
+						const StoreStmt* store = SVFUtil::cast<StoreStmt>(s);
+						add(store->getRHSVarID());
+						add(store->getLHSVarID());
+					}
+				}
+			}
+			else if (const AssignStmt* assign = SVFUtil::dyn_cast<AssignStmt>(stmt))
+				add(assign->getRHSVarID());
+			else if (const MultiOpndStmt* multi = SVFUtil::dyn_cast<MultiOpndStmt>(stmt)) {
+				for (u32_t i = 0; i < multi->getOpVarNum(); i++)
+					add(multi->getOpVarID(i));
+				if (const SelectStmt* select = SVFUtil::dyn_cast<SelectStmt>(stmt))
+					add(select->getCondition()->getId());
+			}
+		}
+	}
+}
+
+const AssertionSlice& AssertionSlicer::getCone(NodeID var) {
+	auto it = cones.find(var);
+	if (it == cones.end()) {
+		it = cones.emplace(var, AssertionSlice()).first;
+		std::vector<NodeID> worklist{var};
+		close(it->second, worklist);
+	}
+	return it->second;
+}
+
+bool AssertionSlicer::intersects(const AssertionSlice& cone, const AssertionSlice& slice) const {
+	if (cone.memory && slice.memory)
+		return true;
+	const AssertionSlice& smaller = cone.vars.size() < slice.vars.size() ? cone : slice;
+	const AssertionSlice& larger = cone.vars.size() < slice.vars.size() ? slice : cone;
+	for (NodeID id : smaller.vars) {
+		const SVFVar* var = svfir->getGNode(id);
+		if (SVFUtil::isa<ValVar>(var) && !SVFUtil::isa<ConstDataValVar>(var) && larger.contains(id))
+			return true;
+	}
+	return false;
+}
+
+/// The branches deciding whether the sink is reached are found with a backward walk from the sink on the
+/// ICFG (ignoring calling contexts), the others join the slice once their cone intersects it
+const AssertionSlice& AssertionSlicer::getSlice(const CallICFGNode* sink) {
+	auto it = slices.find(sink);
+	if (it != slices.end())
+		return it->second;
+	AssertionSlice& slice = slices[sink];
+	std::vector<NodeID> worklist{sink->getActualParms().at(0)->getId()};
+
+	Set<const ICFGNode*> reaching{sink};
+	std::vector<const ICFGNode*> nodes{sink};
+	while (!nodes.empty()) {
+		const ICFGNode* node = nodes.back();
+		nodes.pop_back();
+		for (const ICFGEdge* edge : node->getInEdges()) {
+			if (reaching.insert(edge->getSrcNode()).second)
+				nodes.push_back(edge->getSrcNode());
+		}
+	}
+
+	std::vector<NodeID> pending;
+	for (const ICFGNode* branch : branches) {
+		if (reaching.find(branch) == reaching.end())
+			continue;
+		NodeID cond = 0;
+		bool deciding = false;
+		for (const ICFGEdge* edge : branch->getOutEdges()) {
+			const IntraCFGEdge* intra = SVFUtil::dyn_cast<IntraCFGEdge>(edge);
+			if (!intra || !intra->getCondition())
+				continue;
+			cond = intra->getCondition()->getId();
+			if (reaching.find(intra->getDstNode()) == reaching.end())
+				deciding = true;
+		}
+		if (deciding)
+			worklist.push_back(cond);
+		else
+			pending.push_back(cond);
+	}
+	close(slice, worklist);
+
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (u32_t i = 0; i < pending.size();) {
+			bool contained = slice.contains(pending[i]);
+			if (contained || intersects(getCone(pending[i]), slice)) {
+				if (!contained)
+					slice.merge(getCone(pending[i]));
+				pending[i] = pending.back();
+				pending.pop_back();
+				changed = true;
+			}
+			else
+				i++;
+		}
+	}
+	return slice;
+}
@@ -0,0 +1,102 @@
+//===- AssertionSlicer.h -- Assertion-directed backward slicing for SSE --------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Assertion-directed backward slicing for SSE
+ *
+ * The slice of an assertion is the set of SVFVars its actual parameter depends on:
+ * (1) data dependence: the operands of the SVFStmts defining a var in the slice (SVFVar::getInEdges).
+ * Memory is not partitioned: once a LoadStmt is in the slice, every StoreStmt (value and pointer) is.
+ * (2) control dependence: the condition of a branch is in the slice if one of its successors cannot
+ * reach the assertion on the ICFG (the branch decides whether the assertion is reached), or if its
+ * own cone shares a non-constant ValVar (or memory) with the slice, up to a fixpoint.
+ *
+ * SSE skips the statements defining vars outside the slice and collapses the branches whose condition
+ * is outside it (both successors are feasible without adding a literal). This over-approximates the
+ * feasible paths: a verified assertion stays verified, but a violation may be spurious if a collapsed
+ * branch correlates with the slice in a way the approximation misses (e.g., through a callee).
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_ASSERTIONSLICER_H
+#define SOFTWARE_SECURITY_ANALYSIS_ASSERTIONSLICER_H
+
+#include "SVFIR/SVFIR.h"
+
+namespace SVF {
+
+	/// Backward slice (or cone of a single var), closed under data dependence
+	struct AssertionSlice {
+		Set<NodeID> vars;
+		bool memory;	///< a LoadStmt is in the slice, so are all StoreStmts
+
+		AssertionSlice()
+		: memory(false) {
+		}
+
+		inline bool contains(NodeID id) const {
+			return vars.find(id) != vars.end();
+		}
+
+		/// Return true if stmt defines a var of the slice (or is a store the slice reads)
+		bool isRelevant(const SVFStmt* stmt) const;
+
+		/// Return true if the condition of a branch is in the slice
+		inline bool isRelevant(const IntraCFGEdge* branch) const {
+			return contains(branch->getCondition()->getId());
+		}
+
+		/// Union, a union of closed slices is closed
+		inline void merge(const AssertionSlice& other) {
+			vars.insert(other.vars.begin(), other.vars.end());
+			memory |= other.memory;
+		}
+	};
+
+	class AssertionSlicer {
+	 public:
+		AssertionSlicer(SVFIR* svfir, ICFG* icfg);
+
+		/// Return the slice of an assertion, computed on first use
+		const AssertionSlice& getSlice(const CallICFGNode* sink);
+
+	 private:
+		/// Add the vars in worklist and their data dependences to slice
+		void close(AssertionSlice& slice, std::vector<NodeID>& worklist);
+
+		/// Cone of the condition var of a branch, shared by all slices
+		const AssertionSlice& getCone(NodeID var);
+
+		/// Return true if cone and slice share a non-constant ValVar or both read memory
+		bool intersects(const AssertionSlice& cone, const AssertionSlice& slice) const;
+
+		/// Collect the ICFG nodes with conditional out edges
+		void collectBranches();
+
+		SVFIR* svfir;
+		ICFG* icfg;
+		std::vector<const ICFGNode*> branches;
+		Map<NodeID, AssertionSlice> cones;
+		Map<const ICFGNode*, AssertionSlice> slices;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_ASSERTIONSLICER_H
@@ -0,0 +1,175 @@
+//===- AssertionVerdict.cpp -- Per-assertion verdicts of SSE -----------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Per-assertion verdicts of SSE
+ */
+
+#include "AssertionVerdict.h"
+#include <fstream>
+#include <iomanip>
+
+using namespace SVF;
+using namespace SVFUtil;
+
+const char* AssertionVerdict::getKindName(Kind kind) {
+	switch (kind) {
+	case Verified:
+		return "verified";
+	case Violated:
+		return "violated";
+	case Unknown:
+		return "unknown";
+	case BudgetExceeded:
+		return "budget-exceeded";
+	}
+	return "";
+}
+
+/// The smallest counterexample text is kept, so the verdict does not depend on the exploration order
+void VerdictTable::record(const ICFGNode* sink, Z3Mgr::CheckResult res, const std::string& counterexample) {
+	AssertionVerdict& verdict = get(sink);
+	verdict.paths++;
+	if (res == Z3Mgr::Sat) {
+		verdict.kind = AssertionVerdict::Violated;
+		if (verdict.counterexample.empty() || counterexample < verdict.counterexample)
+			verdict.counterexample = counterexample;
+	}
+	else if (res == Z3Mgr::Unknown && verdict.kind != AssertionVerdict::Violated)
+		verdict.kind = AssertionVerdict::Unknown;
+}
+
+void VerdictTable::merge(const VerdictTable& other) {
+	for (const auto& it : other.verdicts) {
+		const AssertionVerdict& v = it.second;
+		AssertionVerdict& merged = get(v.sink);
+		merged.paths += v.paths;
+		merged.partial = merged.partial || v.partial;
+		if (v.kind == AssertionVerdict::Violated) {
+			merged.kind = AssertionVerdict::Violated;
+			if (merged.counterexample.empty() || v.counterexample < merged.counterexample)
+				merged.counterexample = v.counterexample;
+		}
+		else if (v.kind == AssertionVerdict::Unknown && merged.kind != AssertionVerdict::Violated)
+			merged.kind = AssertionVerdict::Unknown;
+	}
+}
+
+void VerdictTable::markPartial(const ICFGNode* sink) {
+	get(sink).partial = true;
+}
+
+void VerdictTable::finish(const std::set<const ICFGNode*>& sinks) {
+	for (const ICFGNode* sink : sinks)
+		get(sink);
+	for (auto& it : verdicts) {
+		AssertionVerdict& v = it.second;
+		if (v.partial && v.kind != AssertionVerdict::Violated)
+			v.kind = AssertionVerdict::BudgetExceeded;
+	}
+}
+
+void VerdictTable::print() const {
+	for (const auto& it : verdicts) {
+		const AssertionVerdict& v = it.second;
+		std::stringstream ss;
+		switch (v.kind) {
+		case AssertionVerdict::Violated:
+			ss << "The assertion is unsatisfiable!! (" << v.sink->toString() << ")" << "\n";
+			ss << "Counterexample: " << v.counterexample << "\n";
+			break;
+		case AssertionVerdict::Unknown:
+			ss << "The assertion could not be decided within the solver limits!! (" << v.sink->toString() << ")" << "\n";
+			break;
+		case AssertionVerdict::BudgetExceeded:
+			ss << "The assertion was not fully analysed within the budgets!! (" << v.sink->toString() << ")" << "\n";
+			break;
+		case AssertionVerdict::Verified:
+			ss << "The assertion is successfully verified!! (" << v.sink->toString() << ")" << "\n";
+			break;
+		}
+		ss << "Checked on " << v.paths << " path(s)\n";
+		SVFUtil::outs() << ss.str() << std::endl;
+	}
+}
+
+u32_t VerdictTable::getNum(AssertionVerdict::Kind kind) const {
+	u32_t num = 0;
+	for (const auto& it : verdicts) {
+		if (it.second.kind == kind)
+			num++;
+	}
+	return num;
+}
+
+/// JSON string literal of s
+static std::string jsonString(const std::string& s) {
+	std::stringstream ss;
+	ss << '"';
+	for (unsigned char c : s) {
+		if (c == '"' || c == '\\')
+			ss << '\\' << c;
+		else if (c == '\n')
+			ss << "\\n";
+		else if (c == '\t')
+			ss << "\\t";
+		else if (c < 0x20)
+			ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (u32_t) c << std::dec << std::setfill(' ');
+		else
+			ss << c;
+	}
+	ss << '"';
+	return ss.str();
+}
+
+/// One object per assertion, in ICFGNode ID order, followed by the number of assertions per verdict
+void VerdictTable::writeReport(std::ostream& out) const {
+	out << "{\n  \"assertions\": [";
+	const char* sep = "\n";
+	for (const auto& it : verdicts) {
+		const AssertionVerdict& v = it.second;
+		out << sep << "    {\"node\": " << it.first;
+		if (v.sink->getFun())
+			out << ", \"function\": " << jsonString(v.sink->getFun()->getName());
+		out << ", \"location\": " << jsonString(v.sink->toString());
+		out << ", \"verdict\": \"" << AssertionVerdict::getKindName(v.kind) << "\"";
+		out << ", \"paths\": " << v.paths;
+		if (v.kind == AssertionVerdict::Violated)
+			out << ", \"counterexample\": " << jsonString(v.counterexample);
+		out << "}";
+		sep = ",\n";
+	}
+	out << "\n  ],\n  \"summary\": {";
+	sep = "";
+	for (AssertionVerdict::Kind kind : {AssertionVerdict::Verified, AssertionVerdict::Violated, AssertionVerdict::Unknown, AssertionVerdict::BudgetExceeded}) {
+		out << sep << "\"" << AssertionVerdict::getKindName(kind) << "\": " << getNum(kind);
+		sep = ", ";
+	}
+	out << "}\n}\n";
+}
+
+bool VerdictTable::writeReport(const std::string& fileName) const {
+	std::ofstream out(fileName);
+	if (!out)
+		return false;
+	writeReport(out);
+	return out.good();
+}
@@ -0,0 +1,108 @@
+//===- AssertionVerdict.h -- Per-assertion verdicts of SSE -------------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Per-assertion verdicts of SSE
+ *
+ * The result of checking an assertion on each path reaching it is folded into one verdict per assertion
+ * site: Violated dominates Unknown, which dominates Verified, so a verdict does not depend on the order
+ * the paths were checked in (nor on which thread checked them, see ParallelSSE). An assertion whose paths
+ * were not all checked because a budget ran out is BudgetExceeded, unless a counterexample was found.
+ * The table can be written as a JSON report.
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_ASSERTIONVERDICT_H
+#define SOFTWARE_SECURITY_ANALYSIS_ASSERTIONVERDICT_H
+
+#include "SVFIR/SVFIR.h"
+#include "Z3Mgr.h"
+#include <map>
+
+namespace SVF {
+
+	/// Merged result of checking one assertion on all paths reaching it
+	struct AssertionVerdict {
+		enum Kind {
+			Verified,	///< the assertion holds on all paths
+			Violated,	///< a counterexample was found on some path
+			Unknown,	///< not violated, but some path could not be decided within the solver limits
+			BudgetExceeded	///< not violated, but some paths were not checked because a budget ran out
+		};
+		const ICFGNode* sink;
+		Kind kind;
+		u32_t paths;	///< number of feasible paths checked
+		bool partial;	///< some paths to the assertion were not explored
+		std::string counterexample;	///< smallest counterexample text over all violating paths
+
+		AssertionVerdict(const ICFGNode* s = nullptr)
+		: sink(s)
+		, kind(Verified)
+		, paths(0)
+		, partial(false) {
+		}
+
+		static const char* getKindName(Kind kind);
+	};
+
+	class VerdictTable {
+	 public:
+		typedef std::map<NodeID, AssertionVerdict> Verdicts;	///< in ICFGNode ID order
+
+		/// Fold the result of checking sink on one path, counterexample is the model of a Sat result
+		void record(const ICFGNode* sink, Z3Mgr::CheckResult res, const std::string& counterexample);
+
+		/// Fold the verdicts of other into this table
+		void merge(const VerdictTable& other);
+
+		/// Record that not all paths to sink were explored
+		void markPartial(const ICFGNode* sink);
+
+		/// Give every sink a verdict (an assertion no path reaches holds) and turn the partial ones into BudgetExceeded
+		void finish(const std::set<const ICFGNode*>& sinks);
+
+		/// Print the verdict of each assertion
+		void print() const;
+
+		/// Write the table as JSON, return false if the file cannot be written
+		bool writeReport(const std::string& fileName) const;
+		void writeReport(std::ostream& out) const;
+
+		/// Number of assertions with verdict kind
+		u32_t getNum(AssertionVerdict::Kind kind) const;
+
+		inline const Verdicts& getVerdicts() const {
+			return verdicts;
+		}
+		inline void clear() {
+			verdicts.clear();
+		}
+
+	 private:
+		inline AssertionVerdict& get(const ICFGNode* sink) {
+			return verdicts.emplace(sink->getId(), AssertionVerdict(sink)).first->second;
+		}
+
+		Verdicts verdicts;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_ASSERTIONVERDICT_H
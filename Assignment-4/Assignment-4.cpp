@@ -34,28 +34,44 @@ using namespace llvm;
 using namespace z3;
 
 /// TODO: Implement your context-sensitive ICFG traversal here to traverse each program path (once for any loop) from
-/// You will need to collect each path from src node to snk node and then add the path to the `paths` set by
+/// You will need to collect each path from src node to snk node and then pass the path to the path consumer by
 /// calling the `collectAndTranslatePath` method which is then trigger the path translation.
 /// This implementation, slightly different from Assignment-1, requires ICFGNode* as the first argument.
+/// In incremental mode (isIncremental()), translate each edge with pushEdge when it is appended to `path` and do not
+/// descend further if pushEdge returns false (the path prefix is infeasible); call popEdge when the edge is removed
+/// (checkFirstPath in Test4.cpp pushes and pops a single path this way).
+/// Use isSink(node, sink) to test for the end of a path. In multi-sink mode (sink is nullptr), every assertion reached
+/// is checked by collectAndTranslatePath and the traversal then continues past it towards the other assertions.
+/// `callstack` is an interned call stack (a CtxID of getCallingCtxTrie(), not a vector of call sites): use
+/// pushCallStack/popCallStack on call/return edges, nextCallStack tells whether a return edge matches it.
+/// To unroll loops up to the bounds of getBudget(), use visitEdge/unvisitEdge instead of the visited set. Stop extending
+/// the path when canDescend() returns false, and call getBudget().countPath() for each path reaching a sink.
+/// With function summaries enabled, call summarizeCall after translating a CallCFGEdge: if it returns true, the callee
+/// has been summarized and the traversal follows the returned RetCFGEdge instead of the callee's body.
 void SSE::reachability(const ICFGEdge* curEdge, const ICFGNode* sink) {
 
 }
 
 /// TODO: collect each path once this method is called during reachability analysis, and
 /// Collect each program path from the entry to each assertion of the program. In this function,
-/// you will need (1) add each path into the paths set, (2) call translatePath to convert each path into Z3 expressions.
+/// you will need (1) pass each path to the path consumer with consumePath(), (2) call translatePath to convert each path into Z3 expressions.
 /// Note that translatePath returns true if the path is feasible, false if the path is infeasible. (3) If a path is feasible,
 /// you will need to call assertchecking to verify the assertion (which is the last ICFGNode of this path).
+/// In incremental mode, the path has already been translated by pushEdge and only needs step (3).
+/// assertchecking checks in its own solver scope, so the path condition stays in place for the rest of the traversal.
 void SSE::collectAndTranslatePath() {
 	/// TODO: your code starts from here
 }
 
 /// TODO: Implement handling of function calls
+/// `callingCtx` is an interned calling context (a CtxID), enter the callee with pushCallingCtx(calledge->getCallSite()).
+/// The callee context set here is the one function summaries are instantiated in (see summarizeCall)
 void SSE::handleCall(const CallCFGEdge* calledge) {
 
 }
 
 /// TODO: Implement handling of function returns
+/// Leave the callee with popCallingCtx(), the actual return value is in the context of the caller.
 void SSE::handleRet(const RetCFGEdge* retEdge) {
 
 }
@@ -72,27 +88,48 @@ void SSE::handleRet(const RetCFGEdge* retEdge) {
 /// edge->getSuccessorCondValue() returns the actual condition value (1/0 for if/else) when this branch/IntraCFGEdge is executed. For example, the successorCondValue is 1 on the edge from ICFGNode1 to ICFGNode2, and 0 on the edge from ICFGNode1 to ICFGNode3
 bool SSE::handleBranch(const IntraCFGEdge* edge) {
 	assert(edge->getCondition() && "not a conditional control-flow transfer?");
+	DBOP(std::cout << "@@ Analyzing Branch " << edge->toString() << "\n");
+	if (!isInSlice(edge)) {
+		DBOP(std::cout << " This conditional ICFGEdge is outside the slice, collapsed\n");
+		collapsedBranches++;
+		return true;
+	}
 	expr cond = getZ3Expr(edge->getCondition()->getId());
-	expr successorVal = getCtx().int_val((int) edge->getSuccessorCondValue());
+	expr successorVal = getZ3Val((int) edge->getSuccessorCondValue());
 
-	DBOP(std::cout << "@@ Analyzing Branch " << edge->toString() << "\n");
-        getSolver().push();
-        addToSolver(cond == successorVal);
-        check_result res = getSolver().check();
-        getSolver().pop();
-	if (res == z3::unsat)
+	expr lit = cond == successorVal;
+	Z3Mgr::CheckResult res;
+	if (z3Mgr->isConflicting(lit)) {
+		DBOP(std::cout << " This conditional ICFGEdge completes a learned conflict\n");
+		conflictPrunes++;
+		res = Z3Mgr::Unsat;
+	}
+	else if (z3Mgr->usesComponentSolver())
+		res = checkSolver(&lit);
+	else if (!useFeasibilityCache || !z3Mgr->lookupFeasibility(lit, res)) {
+		z3Mgr->pushSolver();
+		z3Mgr->addToSolver(lit);
+		res = checkSolver();
+		z3Mgr->popSolver();
+		if (useFeasibilityCache)
+			z3Mgr->recordFeasibility(lit, res);
+	}
+	if (!isFeasible(res))
 	{
 		DBOP(std::cout << " This conditional ICFGEdge is infeasible!!\n");
 		return false;
 	} else {
 		DBOP(std::cout << "This conditional ICFGEdge is feasible\n");
-		addToSolver(cond == successorVal);
+		addBranchCondition(lit);
 		return true;
 	}
 }
 
 /// TODO: Translate AddrStmt, CopyStmt, LoadStmt, StoreStmt, GepStmt and CmpStmt
 /// Translate AddrStmt, CopyStmt, LoadStmt, StoreStmt, GepStmt, BinaryOPStmt, CmpStmt, SelectStmt, and PhiStmt
+/// Z3_BV_WIDTH may select a bit-vector value domain instead of Int, so build numerals with getZ3Val (not ctx.int_val)
+/// and any other value with the sort z3Mgr->getValSort(), e.g., a GepStmt offset is getZ3Val(offset)
+/// With slicing enabled, the statements outside the slice of the assertion(s) checked are skipped
 bool SSE::handleNonBranch(const IntraCFGEdge* edge) {
 	const ICFGNode* dstNode = edge->getDstNode();
 	const ICFGNode* srcNode = edge->getSrcNode();
@@ -100,6 +137,12 @@ bool SSE::handleNonBranch(const IntraCFGEdge* edge) {
 
 	for (const SVFStmt *stmt : dstNode->getSVFStmts())
 	{
+		if (!isInSlice(stmt)) {
+			skippedStmts++;
+			continue;
+		}
+		if (!SVFUtil::isa<PhiStmt>(stmt))
+			newDefinition(stmt);
 		if (const AddrStmt *addr = SVFUtil::dyn_cast<AddrStmt>(stmt))
 		{
             /// TODO: Implement handling (1) AddrStmt
@@ -125,7 +168,7 @@ bool SSE::handleNonBranch(const IntraCFGEdge* edge) {
 		/// cmp->getResID() returns the result operand "r" and cmp->getPredicate() gives you the predicate ">"
 		/// Find the comparison predicates in "class CmpStmt:Predicate" under SVF/svf/include/SVFIR/SVFStatements.h
 		/// You are only required to handle integer predicates, including ICMP_EQ, ICMP_NE, ICMP_UGT, ICMP_UGE, ICMP_ULT, ICMP_ULE, ICMP_SGT, ICMP_SGE, ICMP_SLE, ICMP_SLT
-		/// We assume integer-overflow-free in this assignment
+		/// We assume integer-overflow-free in this assignment, unless a bit-vector value domain is selected (see Z3Mgr::ValueDomain)
 		else if (const CmpStmt *cmp = SVFUtil::dyn_cast<CmpStmt>(stmt))
 		{
 			expr op0 = getZ3Expr(cmp->getOpVarID(0));
@@ -136,26 +179,34 @@ bool SSE::handleNonBranch(const IntraCFGEdge* edge) {
 			switch (predicate)
 			{
 			case CmpInst::ICMP_EQ:
-				addToSolver(res == ite(op0 == op1, getCtx().int_val(1), getCtx().int_val(0)));
+				addToSolver(res == ite(op0 == op1, getZ3Val(1), getZ3Val(0)));
 				break;
 			case CmpInst::ICMP_NE:
-				addToSolver(res == ite(op0 != op1, getCtx().int_val(1), getCtx().int_val(0)));
+				addToSolver(res == ite(op0 != op1, getZ3Val(1), getZ3Val(0)));
 				break;
 			case CmpInst::ICMP_UGT:
+				addToSolver(res == ite(z3Mgr->mkUGt(op0, op1), getZ3Val(1), getZ3Val(0)));
+				break;
 			case CmpInst::ICMP_SGT:
-				addToSolver(res == ite(op0 > op1, getCtx().int_val(1), getCtx().int_val(0)));
+				addToSolver(res == ite(op0 > op1, getZ3Val(1), getZ3Val(0)));
 				break;
 			case CmpInst::ICMP_UGE:
+				addToSolver(res == ite(z3Mgr->mkUGe(op0, op1), getZ3Val(1), getZ3Val(0)));
+				break;
 			case CmpInst::ICMP_SGE:
-				addToSolver(res == ite(op0 >= op1, getCtx().int_val(1), getCtx().int_val(0)));
+				addToSolver(res == ite(op0 >= op1, getZ3Val(1), getZ3Val(0)));
 				break;
 			case CmpInst::ICMP_ULT:
+				addToSolver(res == ite(z3Mgr->mkULt(op0, op1), getZ3Val(1), getZ3Val(0)));
+				break;
 			case CmpInst::ICMP_SLT:
-				addToSolver(res == ite(op0 < op1, getCtx().int_val(1), getCtx().int_val(0)));
+				addToSolver(res == ite(op0 < op1, getZ3Val(1), getZ3Val(0)));
 				break;
 			case CmpInst::ICMP_ULE:
+				addToSolver(res == ite(z3Mgr->mkULe(op0, op1), getZ3Val(1), getZ3Val(0)));
+				break;
 			case CmpInst::ICMP_SLE:
-				addToSolver(res == ite(op0 <= op1, getCtx().int_val(1), getCtx().int_val(0)));
+				addToSolver(res == ite(op0 <= op1, getZ3Val(1), getZ3Val(0)));
 				break;
 			default:
 				assert(false && "implement this part");
@@ -181,22 +232,22 @@ bool SSE::handleNonBranch(const IntraCFGEdge* edge) {
 				addToSolver(res == op0 / op1);
 				break;
 			case BinaryOperator::SRem:
-				addToSolver(res == op0 % op1);
+				addToSolver(res == z3Mgr->mkSRem(op0, op1));
 				break;
 			case BinaryOperator::Xor:
-				addToSolver(res == bv2int(int2bv(32, op0) ^ int2bv(32, op1), 1));
+				addToSolver(res == z3Mgr->mkXor(op0, op1));
 				break;
 			case BinaryOperator::And:
-				addToSolver(res == bv2int(int2bv(32, op0) & int2bv(32, op1), 1));
+				addToSolver(res == z3Mgr->mkAnd(op0, op1));
 				break;
 			case BinaryOperator::Or:
-				addToSolver(res == bv2int(int2bv(32, op0) | int2bv(32, op1), 1));
+				addToSolver(res == z3Mgr->mkOr(op0, op1));
 				break;
 			case BinaryOperator::AShr:
-				addToSolver(res == bv2int(ashr(int2bv(32, op0), int2bv(32, op1)), 1));
+				addToSolver(res == z3Mgr->mkAShr(op0, op1));
 				break;
 			case BinaryOperator::Shl:
-				addToSolver(res == bv2int(shl(int2bv(32, op0), int2bv(32, op1)), 1));
+				addToSolver(res == z3Mgr->mkShl(op0, op1));
 				break;
 			default:
 				assert(false && "implement this part");
@@ -211,56 +262,250 @@ bool SSE::handleNonBranch(const IntraCFGEdge* edge) {
 			expr tval = getZ3Expr(select->getTrueValue()->getId());
 			expr fval = getZ3Expr(select->getFalseValue()->getId());
 			expr cond = getZ3Expr(select->getCondition()->getId());
-			addToSolver(res == ite(cond == getCtx().int_val(1), tval, fval));
+			addToSolver(res == ite(cond == getZ3Val(1), tval, fval));
 		}
+		/// The incoming values are looked up before res is (re)defined, as the value coming from the back edge of a loop
+		/// may be res itself in the previous iteration
 		else if (const PhiStmt *phi = SVFUtil::dyn_cast<PhiStmt>(stmt)) {
-			expr res = getZ3Expr(phi->getResID());
-			bool opINodeFound = false;
+			std::vector<expr> opes;
 			for(u32_t i = 0; i < phi->getOpVarNum(); i++){
 				assert(srcNode && "we don't have a predecessor ICFGNode?");
 				if (srcNode->getFun()->postDominate(srcNode->getBB(),phi->getOpICFGNode(i)->getBB()))
-				{
-					expr ope = getZ3Expr(phi->getOpVar(i)->getId());
-					addToSolver(res == ope);
-					opINodeFound = true;
-				}
+					opes.push_back(getZ3Expr(phi->getOpVar(i)->getId()));
 			}
-			assert(opINodeFound && "predecessor ICFGNode of this PhiStmt not found?");
+			assert(!opes.empty() && "predecessor ICFGNode of this PhiStmt not found?");
+			newDefinition(phi);
+			expr res = getZ3Expr(phi->getResID());
+			for (const expr& ope : opes)
+				addToSolver(res == ope);
+		}
+	}
+
+	return true;
+}
+
+/// Re-check an unknown query with limits enlarged by retryBudgetFactor for up to maxRetries times
+Z3Mgr::CheckResult SSE::checkSolver(const z3::expr* lit) {
+	auto start = std::chrono::steady_clock::now();
+	auto check = [&]() {
+		if (lit != nullptr && z3Mgr->usesComponentSolver())
+			return z3Mgr->checkIndependent(*lit, useFeasibilityCache);
+		return z3Mgr->checkSolver();
+	};
+	Z3Mgr::CheckResult res = check();
+	if (res == Z3Mgr::Unknown && unknownPolicy == RetryWithLargerBudget) {
+		u32_t timeout = z3Mgr->getTimeout();
+		u32_t rlimit = z3Mgr->getRLimit();
+		u32_t maxMemory = z3Mgr->getMaxMemory();
+		for (u32_t i = 0; i < maxRetries && res == Z3Mgr::Unknown; i++) {
+			z3Mgr->setTimeout(z3Mgr->getTimeout() * retryBudgetFactor);
+			z3Mgr->setRLimit(z3Mgr->getRLimit() * retryBudgetFactor);
+			z3Mgr->setMaxMemory(z3Mgr->getMaxMemory() * retryBudgetFactor);
+			res = check();
 		}
+		z3Mgr->setTimeout(timeout);
+		z3Mgr->setRLimit(rlimit);
+		z3Mgr->setMaxMemory(maxMemory);
 	}
+	if (res == Z3Mgr::Unknown)
+		unknownQueries++;
+	budget.addSolverTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	return res;
+}
 
+/// Translate a single ICFGEdge, return false if it is an infeasible branch
+/// (or, with conflict learning, if its constraints complete a learned conflict)
+bool SSE::translateEdge(const ICFGEdge* edge) {
+	bool learning = z3Mgr->isConflictLearning();
+	if (learning)
+		z3Mgr->beginConstraintGroup();
+	bool feasible = true;
+	if (const IntraCFGEdge* intraEdge = SVFUtil::dyn_cast<IntraCFGEdge>(edge)) {
+		feasible = handleIntra(intraEdge);
+	}
+	else if (const CallCFGEdge* call = SVFUtil::dyn_cast<CallCFGEdge>(edge)) {
+		CtxID calleeCtx = getCallingCtxTrie().push(callingCtx, call->getCallSite());
+		for (const CallPE* pe : call->getCallPEs())
+			z3Mgr->newDefinition(pe->getLHSVarID(), calleeCtx);
+		handleCall(call);
+	}
+	else if (const RetCFGEdge* ret = SVFUtil::dyn_cast<RetCFGEdge>(edge)) {
+		if (const RetPE* pe = ret->getRetPE()) {
+			CtxID callerCtx = callingCtx == CallingCtxTrie::EmptyCtx ? callingCtx : getCallingCtxTrie().pop(callingCtx);
+			z3Mgr->newDefinition(pe->getLHSVarID(), callerCtx);
+		}
+		handleRet(ret);
+	}
+	else
+		assert(false && "what other edges we have?");
+	if (learning && z3Mgr->endConstraintGroup() && feasible) {
+		DBOP(std::cout << " This ICFGEdge completes a learned conflict\n");
+		conflictPrunes++;
+		feasible = false;
+	}
+	return feasible;
+}
+
+/// The return edge is looked up first, so nothing is added for a callee that never returns
+bool SSE::summarizeCall(const CallCFGEdge* call, const RetCFGEdge*& ret) {
+	if (!summaryMgr)
+		return false;
+	ret = nullptr;
+	const FunObjVar* callee = call->getDstNode()->getFun();
+	for (const ICFGEdge* edge : call->getCallSite()->getRetICFGNode()->getInEdges()) {
+		const RetCFGEdge* retEdge = SVFUtil::dyn_cast<RetCFGEdge>(edge);
+		if (retEdge && retEdge->getSrcNode()->getFun() == callee)
+			ret = retEdge;
+	}
+	if (!ret)
+		return false;
+	const FunctionSummary* summary = summaryMgr->getSummary(call);
+	if (!summary)
+		return false;
+	DBOP(std::cout << "@@ Applying the summary of " << callee->getName() << "\n");
+	Set<NodeID> formals;
+	for (const CallPE* pe : call->getCallPEs())
+		formals.insert(pe->getLHSVarID());
+	for (const std::pair<NodeID, z3::expr>& var : summary->vars) {
+		if (formals.find(var.first) == formals.end())
+			z3Mgr->newDefinition(var.first, callingCtx);
+	}
+	summaryMgr->instantiate(*summary);
 	return true;
 }
 
 /// Traverse each program path
 bool SSE::translatePath(std::vector<const ICFGEdge*>& path) {
 	for (const ICFGEdge* edge : path) {
-		if (const IntraCFGEdge* intraEdge = SVFUtil::dyn_cast<IntraCFGEdge>(edge)) {
-			if (handleIntra(intraEdge) == false)
+		if (translateEdge(edge) == false)
+			return false;
+	}
+
+	return true;
+}
+
+/// Open a solver scope (which also scopes memory stores) and translate the edge in it
+bool SSE::pushEdge(const ICFGEdge* edge) {
+	z3Mgr->pushSolver();
+	edgeScopes.push_back(EdgeScope{callingCtx, z3Mgr->getDefinitionMark()});
+	return translateEdge(edge);
+}
+
+/// Drop the constraints and stores of the last pushed edge and restore its calling context
+void SSE::popEdge() {
+	assert(!edgeScopes.empty() && "popEdge without pushEdge?");
+	callingCtx = edgeScopes.back().callingCtx;
+	z3Mgr->undoDefinitions(edgeScopes.back().defMark);
+	edgeScopes.pop_back();
+	z3Mgr->popSolver();
+}
+
+/// The result of a MultiOpndStmt, or the LHS of an AssignStmt other than a StoreStmt (whose LHS is the pointer stored to)
+void SSE::newDefinition(const SVFStmt* stmt) {
+	if (const MultiOpndStmt* multi = SVFUtil::dyn_cast<MultiOpndStmt>(stmt))
+		z3Mgr->newDefinition(multi->getResID(), callingCtx);
+	else if (const AssignStmt* assign = SVFUtil::dyn_cast<AssignStmt>(stmt)) {
+		if (!SVFUtil::isa<StoreStmt>(stmt))
+			z3Mgr->newDefinition(assign->getLHSVarID(), callingCtx);
+	}
+}
+
+/// Recursive calls are not followed, and a return with an empty call stack leaves a function entered from
+/// the program entry, so any caller is followed
+bool SSE::nextCallStack(CtxID cur, const ICFGEdge* edge, CtxID& next) {
+	CallingCtxTrie& trie = getCallingCtxTrie();
+	if (const CallCFGEdge* call = SVFUtil::dyn_cast<CallCFGEdge>(edge)) {
+		for (CtxID ctx = cur; ctx != CallingCtxTrie::EmptyCtx; ctx = trie.pop(ctx)) {
+			if (trie.getCallSite(ctx) == call->getCallSite())
 				return false;
 		}
-		else if (const CallCFGEdge* call = SVFUtil::dyn_cast<CallCFGEdge>(edge)) {
-			handleCall(call);
-		}
-		else if (const RetCFGEdge* ret = SVFUtil::dyn_cast<RetCFGEdge>(edge)) {
-			handleRet(ret);
-		}
+		next = trie.push(cur, call->getCallSite());
+	}
+	else if (const RetCFGEdge* ret = SVFUtil::dyn_cast<RetCFGEdge>(edge)) {
+		if (cur == CallingCtxTrie::EmptyCtx)
+			next = cur;
+		else if (trie.getCallSite(cur) == ret->getCallSite())
+			next = trie.pop(cur);
 		else
-			assert(false && "what other edges we have?");
+			return false;
 	}
-
+	else
+		next = cur;
 	return true;
 }
 
+/// Slices are computed once per sink and kept for the whole run.
+/// Outside batch mode a spurious violation found on a slice would abort the run, so nothing is sliced
+void SSE::selectSlice(const ICFGNode* sink) {
+	activeSlice = nullptr;
+	if (!slicing || !batchMode)
+		return;
+	if (!slicer)
+		slicer = new AssertionSlicer(svfir, icfg);
+	if (sink)
+		activeSlice = &slicer->getSlice(SVFUtil::cast<CallICFGNode>(sink));
+	else {
+		unionSlice = AssertionSlice();
+		for (const ICFGNode* s : sinks)
+			unionSlice.merge(slicer->getSlice(SVFUtil::cast<CallICFGNode>(s)));
+		activeSlice = &unionSlice;
+	}
+}
+
 /// Program entry
+/// In multi-sink mode, a single traversal from the entry checks all assertions instead of one traversal per assertion.
+/// Once a budget runs out, the remaining assertions are not analysed and are reported with the partial results
 void SSE::analyse() {
+	budget.start();
+	verdicts.clear();
+	std::vector<const ICFGNode*> skipped;
+	bool partial = false;
 	for (const ICFGNode* src : identifySources()) {
 		assert(SVFUtil::isa<GlobalICFGNode>(src) && "reachability should start with GlobalICFGNode!");
+		if (multiSink) {
+			identifySinks();
+			selectSlice(nullptr);
+			const IntraCFGEdge startEdge(nullptr, const_cast<ICFGNode*>(src));
+			reachability(&startEdge, nullptr);
+			resetSolver();
+			partial = budget.isPartial();
+			continue;
+		}
 		for (const ICFGNode* sink : identifySinks()) {
+			if (budget.isExhausted()) {
+				skipped.push_back(sink);
+				if (batchMode)
+					verdicts.markPartial(sink);
+				continue;
+			}
+			selectSlice(sink);
+			u32_t truncated = budget.getTruncatedPathNum();
 			const IntraCFGEdge startEdge(nullptr, const_cast<ICFGNode*>(src));
 			/// start traversing from the entry to each assertion and translate each path
 			reachability(&startEdge, sink);
 			resetSolver();
+			if (batchMode && (budget.isExhausted() || budget.getTruncatedPathNum() > truncated))
+				verdicts.markPartial(sink);
 		}
 	}
-}
\ No newline at end of file
+	consumer->finish();
+	if (budget.isPartial()) {
+		SVFUtil::outs() << SVFUtil::wrnMsg(budget.toString()) << "\n";
+		for (const ICFGNode* sink : skipped)
+			SVFUtil::outs() << "The assertion was not analysed!! (" << sink->toString() << ")\n";
+	}
+	finishVerdicts(partial);
+}
+
+void SSE::finishVerdicts(bool partial) {
+	if (!batchMode)
+		return;
+	if (partial) {
+		for (const ICFGNode* sink : sinks)
+			verdicts.markPartial(sink);
+	}
+	verdicts.finish(sinks);
+	verdicts.print();
+	if (!batchReportFile.empty() && !verdicts.writeReport(batchReportFile))
+		SVFUtil::errs() << SVFUtil::errMsg("cannot write the verification report to " + batchReportFile) << "\n";
+}
@@ -30,23 +30,59 @@
 
 #include "SVF-LLVM/SVFIRBuilder.h"
 #include "Z3SSEMgr.h"
+#include "FunctionSummary.h"
+#include "AssertionSlicer.h"
+#include "AssertionVerdict.h"
+#include "ExplorationBudget.h"
+#include "PathConsumer.h"
+#include "PathArena.h"
 #include <stdlib.h>
+#include <atomic>
 
 namespace SVF {
 
 	class SSE {
 	 public:
 		typedef std::vector<const ICFGNode*> CallStack;
-		typedef std::pair<const ICFGEdge*, CallStack> ICFGEdgeStackPair;
-
-		/// Constructor
-		SSE(SVFIR* s, ICFG* i)
+		typedef CallingCtxTrie::CtxID CtxID;
+		/// Visited ICFGEdge under an interned call stack
+		typedef std::pair<const ICFGEdge*, CtxID> ICFGEdgeStackPair;
+
+		/// How a query answered with Z3Mgr::Unknown (e.g., resource limit hit) is treated
+		enum UnknownPolicy {
+			AssumeFeasible,		///< treat the branch as feasible and keep exploring
+			SkipPath,		///< treat the branch as infeasible and abandon the path
+			RetryWithLargerBudget	///< re-check with enlarged limits, assume feasible if still unknown
+		};
+
+		/// Constructor, the value domain selects the Int or the bit-vector encoding of program values
+		SSE(SVFIR* s, ICFG* i, Z3Mgr::ValueDomain domain = (Z3Mgr::ValueDomain) Z3_BV_WIDTH)
 		: svfir(s)
-		, icfg(i) {
-			z3Mgr = new Z3SSEMgr(s);
+		, callstack(CallingCtxTrie::EmptyCtx)
+		, callingCtx(CallingCtxTrie::EmptyCtx)
+		, icfg(i)
+		, unknownPolicy(AssumeFeasible)
+		, retryBudgetFactor(4)
+		, maxRetries(2)
+		, unknownQueries(0)
+		, incremental(false)
+		, multiSink(false)
+		, useFeasibilityCache(true)
+		, summaryMgr(nullptr)
+		, slicing(false)
+		, slicer(nullptr)
+		, activeSlice(nullptr)
+		, skippedStmts(0)
+		, collapsedBranches(0)
+		, conflictPrunes(0)
+		, consumer(&collector)
+		, batchMode(false) {
+			z3Mgr = new Z3SSEMgr(s, domain);
 		}
 		/// Destructor
 		virtual ~SSE() {
+			delete slicer;
+			delete summaryMgr;
 			delete z3Mgr;
 		}
 
@@ -72,19 +108,69 @@ namespace SVF {
 			        && (fun->getName() == "assert" || fun->getName() == "svf_assert" || fun->getName() == "sink"));
 		}
 
-		/// reset z3 solver
+		/// reset z3 solver, and release the objects of the run (see PathArena)
 		virtual void resetSolver() {
-                	getSolver().reset();
-                        callingCtx.clear();
+                	z3Mgr->resetSolver();
+                        callingCtx = CallingCtxTrie::EmptyCtx;
+                        edgeScopes.clear();
+                        z3Mgr->undoDefinitions(0);
+                        arena.release();
 		}
 
 		/// TODO: Implementing the collection the ICFG paths
 		virtual void collectAndTranslatePath();
 
-		/// Depth-first-search ICFGTraversal on ICFG from src node to snk node
+		/// Depth-first-search ICFGTraversal on ICFG from src node to snk node (snk is nullptr in multi-sink mode)
 		void reachability(const ICFGEdge* curNode, const ICFGNode* snk);
 
-		void analyse();
+		/// Loop unrolling: take edge under the current call stack, return false if it has already been taken
+		/// as many times on the current path as the unroll bound of its function allows (see ExplorationBudget)
+		inline bool visitEdge(const ICFGEdge* edge) {
+			u32_t& count = visitCounts[ICFGEdgeStackPair(edge, callstack)];
+			if (count >= budget.getLoopUnrollBound(edge->getSrcNode()->getFun()))
+				return false;
+			count++;
+			return true;
+		}
+		/// Undo visitEdge when edge is removed from the path
+		inline void unvisitEdge(const ICFGEdge* edge) {
+			auto it = visitCounts.find(ICFGEdgeStackPair(edge, callstack));
+			assert(it != visitCounts.end() && "unvisitEdge without visitEdge?");
+			if (--it->second == 0)
+				visitCounts.erase(it);
+		}
+		/// A loop taken several times redefines its ValVars, so each statement's definition is recorded
+		/// before it is translated and gets a fresh symbol from the second one on (see Z3SSEMgr::newDefinition)
+		void newDefinition(const SVFStmt* stmt);
+		/// Return false if reachability must not extend the current path (a budget ran out, or the path is at the depth bound)
+		inline bool canDescend() {
+			return budget.canDescend(path.size());
+		}
+		/// Loop unrolling bounds and budgets of analyse, the solver time of checkSolver is accounted to it
+		inline ExplorationBudget& getBudget() {
+			return budget;
+		}
+
+		/// Return true if node ends a path to be checked: snk, or any assertion in multi-sink mode
+		inline bool isSink(const ICFGNode* node, const ICFGNode* snk) const {
+			return snk ? node == snk : sinks.find(node) != sinks.end();
+		}
+
+		/// Multi-sink mode: analyse explores the program once and each assertion is checked in place,
+		/// under the path condition of the current prefix, when its CallICFGNode is reached.
+		/// It translates edges incrementally, so it also turns on incremental mode.
+		///@{
+		inline void setMultiSink(bool ms) {
+			multiSink = ms;
+			if (ms)
+				incremental = true;
+		}
+		inline bool isMultiSink() const {
+			return multiSink;
+		}
+		///@}
+
+		virtual void analyse();
 
 		virtual void handleCall(const CallCFGEdge* call);
 		virtual void handleRet(const RetCFGEdge* ret);
@@ -107,7 +193,131 @@ namespace SVF {
 		/// Encode the path into Z3 constraints and return true if the path is feasible, false otherwise.
 		bool translatePath(std::vector<const ICFGEdge*>& path);
 
-		/// Return true if svf_assert check is successful
+		/// Encode a single edge into Z3 constraints, return false if it is an infeasible branch
+		bool translateEdge(const ICFGEdge* edge);
+
+		/// Incremental translation: each edge pushed onto the current path is translated in its own
+		/// solver scope, and popping it restores the solver, memory and calling context of the path prefix.
+		/// Infeasible branches are found when they are pushed, so whole subtrees can be pruned.
+		/// With conflict learning, a pushed edge completing a learned conflict is infeasible without a solver query.
+		///@{
+		/// Translate edge in a new scope, return false if the path prefix becomes infeasible (popEdge is still required)
+		bool pushEdge(const ICFGEdge* edge);
+		void popEdge();
+		inline void setIncremental(bool inc) {
+			incremental = inc;
+		}
+		inline bool isIncremental() const {
+			return incremental;
+		}
+		///@}
+
+		/// Function summaries (see FunctionSummaryMgr): a summarized callee is not traversed, instead the
+		/// traversal translates its call edge, calls summarizeCall and continues with the returned RetCFGEdge
+		///@{
+		inline void setFunctionSummaries(bool summarize) {
+			if (summarize && !summaryMgr)
+				summaryMgr = new FunctionSummaryMgr(this);
+			else if (!summarize) {
+				delete summaryMgr;
+				summaryMgr = nullptr;
+			}
+		}
+		inline FunctionSummaryMgr* getFunctionSummaryMgr() const {
+			return summaryMgr;
+		}
+		/// Apply the summary of the callee of a translated call edge and set ret to the edge returning to the call site,
+		/// return false (and do nothing) if summaries are disabled or the callee cannot be summarized
+		bool summarizeCall(const CallCFGEdge* call, const RetCFGEdge*& ret);
+		///@}
+
+		/// Assertion-directed slicing (see AssertionSlicer): the statements outside the slice of the assertion
+		/// being checked are not translated and the branches outside it are collapsed (taken without a literal).
+		/// Feasibility is over-approximated, so a reported violation may be spurious while verified results stay sound.
+		/// Slicing is therefore only applied in batch mode, where a violation is recorded in the verdicts instead of aborting.
+		///@{
+		inline void setSlicing(bool slice) {
+			slicing = slice;
+			if (!slice)
+				activeSlice = nullptr;
+		}
+		inline bool isSlicing() const {
+			return slicing;
+		}
+		/// Select the slice of sink for the translation, or the union of the slices of all sinks if sink is nullptr
+		void selectSlice(const ICFGNode* sink);
+		/// Return true if stmt has to be translated under the selected slice
+		inline bool isInSlice(const SVFStmt* stmt) const {
+			return activeSlice == nullptr || activeSlice->isRelevant(stmt);
+		}
+		/// Return true if the condition of branch has to be translated under the selected slice
+		inline bool isInSlice(const IntraCFGEdge* branch) const {
+			return activeSlice == nullptr || activeSlice->isRelevant(branch);
+		}
+		inline u32_t getSkippedStmtNum() const {
+			return skippedStmts;
+		}
+		inline u32_t getCollapsedBranchNum() const {
+			return collapsedBranches;
+		}
+		///@}
+
+		/// Conflict learning (see Z3Mgr::beginConstraintGroup): the constraints of each translated edge form a group
+		/// named by an assumption, so an infeasible query yields the minimal set of edges (and their constraints) in
+		/// conflict. Learned conflicts are kept across paths: a branch whose literal completes one is infeasible, and
+		/// so is an edge whose constraints complete one (pushEdge then returns false, before reachability descends)
+		///@{
+		inline void setConflictLearning(bool learn) {
+			z3Mgr->setConflictLearning(learn);
+		}
+		inline const Z3ConflictDB& getConflictDB() const {
+			return z3Mgr->getConflictDB();
+		}
+		/// Number of edges found infeasible by a learned conflict
+		inline u32_t getConflictPruneNum() const {
+			return conflictPrunes;
+		}
+		///@}
+
+		/// Independence splitting (see Z3Mgr::checkIndependent): branch and assertion queries only send the
+		/// constraints sharing symbols (transitively) with their literal to the solver. Sound as long as each
+		/// branch is checked before its literal is added, which handleBranch does
+		///@{
+		inline void setIndependenceSplitting(bool split) {
+			z3Mgr->setIndependenceSplitting(split);
+		}
+		/// Number of queries checked on a component, and constraints left out of them
+		inline u32_t getIndependentQueryNum() const {
+			return z3Mgr->getIndependentQueryNum();
+		}
+		inline u64_t getDroppedConstraintNum() const {
+			return z3Mgr->getDroppedConstraintNum();
+		}
+		///@}
+
+		/// Counterexample cache (see Z3Mgr::setModelCaching): branch and assertion queries are first refuted by
+		/// the unsat cores of earlier queries, then evaluated under the models of earlier (sibling) paths
+		///@{
+		inline void setModelCaching(bool cache) {
+			z3Mgr->setModelCaching(cache);
+		}
+		inline const Z3ModelCache& getModelCache() const {
+			return z3Mgr->getModelCache();
+		}
+		///@}
+
+		/// Check the solver under its resource limits, following the unknown policy on Unknown.
+		/// With independence splitting or model caching, a query for lit (already asserted, or about to be) is
+		/// checked by Z3Mgr::checkIndependent
+		Z3Mgr::CheckResult checkSolver(const z3::expr* lit = nullptr);
+
+		/// Return true if a query result is treated as feasible under the unknown policy
+		inline bool isFeasible(Z3Mgr::CheckResult res) const {
+			return res == Z3Mgr::Sat || (res == Z3Mgr::Unknown && unknownPolicy != SkipPath);
+		}
+
+		/// Return true if svf_assert check is successful.
+		/// The negated assertion is checked in its own solver scope, so the path constraints stay reusable
 		bool assertchecking(const ICFGNode* inode) {
 			assert_checked++;
 			const CallICFGNode* callnode = SVFUtil::cast<CallICFGNode>(inode);
@@ -115,12 +325,35 @@ namespace SVF {
 			       && "last node is not an assert call?");
 			DBOP(std::cout << "\n## Analyzing " << callnode->toString() << "\n");
 			z3::expr arg0 = getZ3Expr(callnode->getActualParms().at(0)->getId());
-			addToSolver(arg0 == getCtx().int_val(0));
-			if (getSolver().check() != z3::unsat) {
+			z3::expr neg = arg0 == getZ3Val(0);
+			z3Mgr->pushSolver();
+			addToSolver(neg);
+			Z3Mgr::CheckResult res = checkSolver(&neg);
+			bool verified = reportAssertion(inode, res);
+			z3Mgr->popSolver();
+			return verified;
+		}
+
+		/// Report the result of checking the negated assertion at inode, in batch mode only record it
+		virtual bool reportAssertion(const ICFGNode* inode, Z3Mgr::CheckResult res) {
+			if (batchMode) {
+				std::stringstream ss;
+				if (res == Z3Mgr::Sat)
+					ss << z3Mgr->getModel();
+				verdicts.record(inode, res, ss.str());
+				return res == Z3Mgr::Unsat;
+			}
+			if (res == Z3Mgr::Unknown) {
+				std::stringstream ss;
+				ss << "The assertion could not be decided within the solver limits!! ("<< inode->toString() << ")" << "\n";
+				SVFUtil::outs() << ss.str() << std::endl;
+				return false;
+			}
+			else if (res == Z3Mgr::Sat) {
 				DBOP(printExprValues());
 				std::stringstream ss;
 				ss << "The assertion is unsatisfiable!! ("<< inode->toString() << ")" << "\n";
-                		ss << "Counterexample: " << getSolver().get_model() << "\n";
+                		ss << "Counterexample: " << z3Mgr->getModel() << "\n";
 				SVFUtil::outs() << ss.str() << std::endl;
 				assert(false);
 				return false;
@@ -134,18 +367,85 @@ namespace SVF {
 			}
 		}
 
-		std::set<std::string> getPaths() {
-			return paths;
+		/// Batch verification: instead of printing each check (and aborting on a violated assertion), the result
+		/// of each check is folded into the verdict of its assertion (see VerdictTable) and the exploration goes on.
+		/// analyse prints the verdicts at the end, and writes them as a JSON report to reportFile if it is not empty
+		///@{
+		inline void setBatchMode(bool batch, const std::string& reportFile = "") {
+			batchMode = batch;
+			batchReportFile = reportFile;
+		}
+		inline bool isBatchMode() const {
+			return batchMode;
+		}
+		inline const VerdictTable& getVerdicts() const {
+			return verdicts;
+		}
+		inline void clearVerdicts() {
+			verdicts.clear();
+		}
+		///@}
+
+		/// Paths found by reachability (see PathConsumer)
+		///@{
+		/// Stream the paths to c (owned by the caller) instead of collecting them, nullptr restores the PathSetCollector
+		inline void setPathConsumer(PathConsumer* c) {
+			consumer = c ? c : &collector;
+		}
+		inline PathConsumer* getPathConsumer() const {
+			return consumer;
+		}
+		/// Pass the current path to the consumer, as the IDs of the destination nodes of its edges
+		void consumePath() {
+			nodeBuffer.clear();
+			for (const ICFGEdge* edge : path)
+				nodeBuffer.push_back(edge->getDstNode()->getId());
+			consumer->consume(nodeBuffer.data(), nodeBuffer.size());
 		}
+		/// Paths collected by the default consumer (empty while another consumer is set)
+		const Set<std::string>& getPaths() const {
+			return collector.getPaths();
+		}
+		///@}
 
+		/// Calling context used for translation, push/pop are O(1) moves in the context trie
         	void pushCallingCtx(const ICFGNode* c) {
-            		callingCtx.push_back(c);
+            		callingCtx = getCallingCtxTrie().push(callingCtx, c);
         	}
 
         	void popCallingCtx() {
-            		callingCtx.pop_back();
+            		callingCtx = getCallingCtxTrie().pop(callingCtx);
         	}
 
+		/// Call stack used by the traversal (e.g., for the visited set)
+		void pushCallStack(const ICFGNode* c) {
+			callstack = getCallingCtxTrie().push(callstack, c);
+		}
+
+		void popCallStack() {
+			callstack = getCallingCtxTrie().pop(callstack);
+		}
+
+		/// Set next to the call stack after following edge from cur, return false if the edge does not match
+		/// cur (a return to another call site, or a recursive call)
+		bool nextCallStack(CtxID cur, const ICFGEdge* edge, CtxID& next);
+
+		inline CallingCtxTrie& getCallingCtxTrie() {
+			return z3Mgr->getCallingCtxTrie();
+		}
+
+		inline SVFIR* getSVFIR() const {
+			return svfir;
+		}
+
+		inline ICFG* getICFG() const {
+			return icfg;
+		}
+
+		inline Z3SSEMgr* getZ3SSEMgr() {
+			return z3Mgr;
+		}
+
 		inline z3::solver& getSolver() {
 			return z3Mgr->getSolver();
 		}
@@ -154,10 +454,48 @@ namespace SVF {
 			return z3Mgr->getCtx();
 		}
 
+		/// Numeral of the value sort of the selected value domain
+		inline z3::expr getZ3Val(int64_t val) {
+			return z3Mgr->getZ3Val(val);
+		}
+
+		/// Per-query solver limits (0 means unbounded), see Z3Mgr
+		inline void setSolverLimits(u32_t timeoutMs, u32_t rlimit, u32_t maxMemoryMB) {
+			z3Mgr->setTimeout(timeoutMs);
+			z3Mgr->setRLimit(rlimit);
+			z3Mgr->setMaxMemory(maxMemoryMB);
+		}
+
+		inline void setUnknownPolicy(UnknownPolicy policy, u32_t budgetFactor = 4, u32_t retries = 2) {
+			unknownPolicy = policy;
+			retryBudgetFactor = budgetFactor;
+			maxRetries = retries;
+		}
+
+		/// Branch feasibility queries are answered from a cache across paths when possible (see Z3FeasibilityCache)
+		///@{
+		inline void setFeasibilityCache(bool use) {
+			useFeasibilityCache = use;
+		}
+		inline const Z3FeasibilityCache& getFeasibilityCache() const {
+			return z3Mgr->getFeasibilityCache();
+		}
+		///@}
+
+		/// Number of queries that remained unknown after applying the unknown policy
+		inline u32_t getUnknownQueryNum() const {
+			return unknownQueries;
+		}
+
 		/// Add expr to Z3 solver
-		void addToSolver(z3::expr e) {
+		virtual void addToSolver(z3::expr e) {
 			DBOP(std::cout << "==> " << e.simplify() << "\n");
-			getSolver().add(e);
+			z3Mgr->addToSolver(e);
+		}
+
+		/// Add the condition of a feasible branch to the path condition
+		virtual void addBranchCondition(z3::expr cond) {
+			addToSolver(cond);
 		}
 
 		/// Return Z3 expression based on ValVar ID
@@ -174,25 +512,62 @@ namespace SVF {
 			return z3Mgr->getEvalExpr(e);
 		}
 
+		/// Model of the last satisfiable check
+		inline const z3::model& getModel() {
+			return z3Mgr->getModel();
+		}
+
 		/// Dump values of all exprs
 		inline void printExprValues() {
 			z3Mgr->printExprValues(callingCtx);
 		}
 
-		static u32_t assert_checked;
+		static std::atomic<u32_t> assert_checked;
 		static u32_t assert_num;
 
 	 private:
 		Z3SSEMgr* z3Mgr;
 		ICFG* icfg;
-		std::set<std::string> paths;
+		UnknownPolicy unknownPolicy;
+		u32_t retryBudgetFactor;	///< limits are multiplied by this factor on each retry
+		u32_t maxRetries;
+		u32_t unknownQueries;
+		bool incremental;	///< translate edges while traversing (pushEdge/popEdge)
+		struct EdgeScope {
+			CtxID callingCtx;	///< calling context before the edge
+			u32_t defMark;		///< definition mark before the edge
+		};
+		std::vector<EdgeScope> edgeScopes;	///< one per pushed edge
+		bool multiSink;	///< explore once and check every assertion in place
+		bool useFeasibilityCache;	///< look up branch feasibility queries in the cache of z3Mgr
+		FunctionSummaryMgr* summaryMgr;	///< function summaries, nullptr if disabled
+		bool slicing;	///< translate only the slice of the assertion(s) checked
+		AssertionSlicer* slicer;	///< created on first use
+		const AssertionSlice* activeSlice;	///< slice selected for the translation, nullptr if none
+		AssertionSlice unionSlice;	///< slice of all sinks (multi-sink mode)
+		u32_t skippedStmts;
+		u32_t collapsedBranches;
+		u32_t conflictPrunes;	///< branches and edges found infeasible by a learned conflict
+		PathSetCollector collector;
+		PathConsumer* consumer;
+		std::vector<NodeID> nodeBuffer;	///< node IDs of the path being consumed
+		bool batchMode;
+		std::string batchReportFile;
 
 	 protected:
+		/// End of a batch run: give every sink a verdict, print them and write the report.
+		/// If partial, no assertion was fully analysed (e.g., a budget ran out in multi-sink mode)
+		void finishVerdicts(bool partial);
+
+		VerdictTable verdicts;
 		SVFIR* svfir;
 		Set<ICFGEdgeStackPair> visited;
-		CallStack callstack;
-		CallStack callingCtx;
+		Map<ICFGEdgeStackPair, u32_t> visitCounts;	///< times each (edge, call stack) is on the current path
+		ExplorationBudget budget;
+		CtxID callstack;	///< interned call stack of the traversal
+		CtxID callingCtx;	///< interned calling context of the translation
 		std::vector<const ICFGEdge*> path;
+		PathArena arena;	///< objects of the current run (e.g., the pending states of ScheduledSSE), released by resetSolver
 
 		std::set<const ICFGNode*> sources;
 		std::set<const ICFGNode*> sinks;
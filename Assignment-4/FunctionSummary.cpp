@@ -0,0 +1,205 @@
+//===- FunctionSummary.cpp -- Function summaries for SSE --------------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Function summaries for SSE
+ */
+
+#include "FunctionSummary.h"
+#include "Assignment-4.h"
+
+using namespace SVF;
+using namespace SVFUtil;
+
+FunctionSummaryMgr::FunctionSummaryMgr(SSE* s)
+: sse(s)
+, maxSummaryPaths(64)
+, summaryNum(0)
+, instantiationNum(0) {
+}
+
+FunctionSummaryMgr::~FunctionSummaryMgr() {
+}
+
+/// Formal parameters are bound to their actual parameters by the translation of call,
+/// so a pointer parameter has a concrete address in the callee context
+const FunctionSummary* FunctionSummaryMgr::getSummary(const CallCFGEdge* call) {
+	Z3SSEMgr* z3Mgr = sse->getZ3SSEMgr();
+	SummaryKey key;
+	key.first = call->getDstNode()->getFun();
+	for (const CallPE* pe : call->getCallPEs()) {
+		int64_t val;
+		if (z3Mgr->getConcreteValue(sse->getZ3Expr(pe->getLHSVarID()), val) && z3Mgr->isVirtualMemAddress((u32_t) val))
+			key.second.push_back(std::make_pair(pe->getLHSVarID(), (u32_t) val));
+	}
+	auto it = summaries.find(key);
+	if (it == summaries.end()) {
+		it = summaries.emplace(key, FunctionSummary()).first;
+		computeSummary(call, key, it->second);
+	}
+	return it->second.valid ? &it->second : nullptr;
+}
+
+void FunctionSummaryMgr::computeSummary(const CallCFGEdge* call, const SummaryKey& key, FunctionSummary& summary) {
+	if (!summarizer) {
+		Z3SSEMgr* z3Mgr = sse->getZ3SSEMgr();
+		summarizer.reset(new SSE(sse->getSVFIR(), sse->getICFG(), z3Mgr->getValueDomain()));
+		summarizer->setFeasibilityCache(false);
+	}
+	Z3SSEMgr* summaryMgr = summarizer->getZ3SSEMgr();
+	summarizer->resetSolver();
+	summaryMgr->setMemPartitions(Z3Mgr::MemPartitions());
+	for (const std::pair<NodeID, u32_t>& bound : key.second)
+		summarizer->addToSolver(summarizer->getZ3Expr(bound.first) == summarizer->getZ3Val(bound.second));
+
+	u32_t concretizations = summaryMgr->getConcretizationNum();
+	Set<const ICFGEdge*> onPath;
+	summary.valid = collectPaths(call->getDstNode(), onPath, summaryMgr->getAssertions().size(), summary)
+	                && summaryMgr->getConcretizationNum() == concretizations;
+	if (summary.valid) {
+		translateSummary(summary);
+		summaryNum++;
+	}
+	else {
+		summary.cases.clear();
+		summary.memOut.clear();
+	}
+	summarizer->resetSolver();
+	summaryMgr->setMemPartitions(Z3Mgr::MemPartitions());
+}
+
+/// Each loop is followed once per path, as in the path-based traversal. A path going around a loop redefines
+/// ValVars under fresh symbols, which the summary would share between instantiations, so it is not summarized.
+/// An assertion has no CallCFGEdge (the assert function is external), so it is found by its call node
+bool FunctionSummaryMgr::collectPaths(const ICFGNode* node, Set<const ICFGEdge*>& onPath, u32_t base, FunctionSummary& summary) {
+	if (const CallICFGNode* callNode = SVFUtil::dyn_cast<CallICFGNode>(node)) {
+		if (sse->isAssertFun(callNode->getCalledFunction()))
+			return false;
+	}
+	if (SVFUtil::isa<FunExitICFGNode>(node)) {
+		Z3SSEMgr* summaryMgr = summarizer->getZ3SSEMgr();
+		if (summary.cases.size() >= maxSummaryPaths || summaryMgr->getRedefinitionNum() > 0)
+			return false;
+		const std::vector<z3::expr>& assertions = summaryMgr->getAssertions();
+		z3::expr_vector constraints(summaryMgr->getCtx());
+		for (u32_t i = base; i < assertions.size(); i++)
+			constraints.push_back(assertions[i]);
+		summary.cases.push_back(z3::mk_and(constraints));
+		summary.memOut.push_back(summaryMgr->getMemPartitions());
+		return true;
+	}
+	for (const ICFGEdge* edge : node->getOutEdges()) {
+		if (SVFUtil::isa<CallCFGEdge>(edge))
+			return false;
+		if (SVFUtil::isa<RetCFGEdge>(edge) || onPath.find(edge) != onPath.end())
+			continue;
+		onPath.insert(edge);
+		bool summarizable = true;
+		if (summarizer->pushEdge(edge))
+			summarizable = collectPaths(edge->getDstNode(), onPath, base, summary);
+		summarizer->popEdge();
+		onPath.erase(edge);
+		if (!summarizable)
+			return false;
+	}
+	return true;
+}
+
+/// Find the ValVars and initial memory contents of the summary with a walk over its exprs
+void FunctionSummaryMgr::translateSummary(FunctionSummary& summary) {
+	z3::context& ctx = sse->getCtx();
+	Z3SSEMgr* summaryMgr = summarizer->getZ3SSEMgr();
+
+	std::vector<z3::expr> roots;
+	for (z3::expr& c : summary.cases) {
+		c = Z3Mgr::translate(c, ctx);
+		roots.push_back(c);
+	}
+	for (Z3Mgr::MemPartitions& mem : summary.memOut) {
+		for (auto& it : mem) {
+			it.second = Z3Mgr::translate(it.second, ctx);
+			roots.push_back(it.second);
+		}
+	}
+
+	Set<u32_t> consts;
+	Set<u32_t> seen;
+	while (!roots.empty()) {
+		z3::expr e = roots.back();
+		roots.pop_back();
+		if (!e.is_app() || !seen.insert(e.id()).second)
+			continue;
+		if (e.is_const() && !e.is_numeral())
+			consts.insert(e.id());
+		else if (e.decl().decl_kind() == Z3_OP_SELECT && e.arg(0).is_const() && e.arg(1).is_numeral())
+			summary.reads.push_back(std::make_pair((u32_t) summaryMgr->getNumeralValue(e.arg(1)), e));
+		for (u32_t i = 0; i < e.num_args(); i++)
+			roots.push_back(e.arg(i));
+	}
+
+	std::vector<std::pair<NodeID, z3::expr>> vars;
+	summaryMgr->getValVarExprs(CallingCtxTrie::EmptyCtx, vars);
+	for (const std::pair<NodeID, z3::expr>& var : vars) {
+		z3::expr e = Z3Mgr::translate(var.second, ctx);
+		if (consts.find(e.id()) != consts.end())
+			summary.vars.push_back(std::make_pair(var.first, e));
+	}
+}
+
+/// The memory after the call holds, at each address written by some path, the contents of the path taken
+void FunctionSummaryMgr::instantiate(const FunctionSummary& summary) {
+	Z3SSEMgr* z3Mgr = sse->getZ3SSEMgr();
+	z3::context& ctx = sse->getCtx();
+	z3::expr_vector from(ctx);
+	z3::expr_vector to(ctx);
+	for (const std::pair<NodeID, z3::expr>& var : summary.vars) {
+		from.push_back(var.second);
+		to.push_back(sse->getZ3Expr(var.first));
+	}
+	for (const std::pair<u32_t, z3::expr>& read : summary.reads) {
+		from.push_back(read.second);
+		to.push_back(z3Mgr->loadValue(sse->getZ3Val(read.first)));
+	}
+
+	z3::expr_vector cases(ctx);
+	for (const z3::expr& c : summary.cases)
+		cases.push_back(z3::expr(c).substitute(from, to));
+	sse->addToSolver(cases.empty() ? ctx.bool_val(false) : z3::mk_or(cases));
+
+	Set<u32_t> written;
+	for (const Z3Mgr::MemPartitions& mem : summary.memOut) {
+		for (const auto& it : mem)
+			written.insert(it.first);
+	}
+	std::vector<std::pair<u32_t, z3::expr>> stores;
+	for (u32_t addr : written) {
+		z3::expr contents = z3Mgr->loadValue(sse->getZ3Val(addr));
+		for (u32_t i = summary.memOut.size(); i > 0; i--) {
+			auto it = summary.memOut[i - 1].find(addr);
+			if (it != summary.memOut[i - 1].end())
+				contents = z3::ite(cases[i - 1], z3::expr(it->second).substitute(from, to), contents);
+		}
+		stores.push_back(std::make_pair(addr, contents));
+	}
+	for (const std::pair<u32_t, z3::expr>& store : stores)
+		z3Mgr->storeValue(sse->getZ3Val(store.first), store.second);
+	instantiationNum++;
+}
@@ -0,0 +1,116 @@
+//===- FunctionSummary.h -- Function summaries for SSE --------------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Function summaries for SSE
+ *
+ * A summary of a callee is the disjunction, over the feasible paths from its FunEntryICFGNode to its
+ * FunExitICFGNode, of (path constraints, memory after the path). The path constraints include the
+ * return value of the callee. Summaries are computed by a separate SSE in its own z3 context, with
+ * the callee's ValVars under the empty calling context and the formal parameters unconstrained,
+ * except pointer parameters, which are bound to the concrete addresses passed by the call site (the
+ * memory model needs concrete addresses). Memory is initially empty, so the callee reads the
+ * initial contents select(loc2ValMap, addr).
+ *
+ * A summary is instantiated at a call site by renaming the callee's ValVars to the callee context of
+ * the caller and by replacing each select(loc2ValMap, addr) with the caller's current contents at addr.
+ * Summaries are kept for the whole run, keyed by callee and bound pointer arguments.
+ * Only leaf functions (without calls) are summarized. A summary is dropped if its translation had to
+ * concretize a symbolic value with a model (see Z3Mgr::getConcretizationNum), if it has too many paths,
+ * or if a path goes around a loop (see Z3SSEMgr::newDefinition).
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_FUNCTIONSUMMARY_H
+#define SOFTWARE_SECURITY_ANALYSIS_FUNCTIONSUMMARY_H
+
+#include "Z3SSEMgr.h"
+#include <map>
+#include <memory>
+
+namespace SVF {
+
+	class SSE;
+
+	/// Summary of a callee, with all exprs in the context of the SSE using it
+	struct FunctionSummary {
+		bool valid;
+		std::vector<z3::expr> cases;		///< path constraints of each feasible path
+		std::vector<Z3Mgr::MemPartitions> memOut;	///< memory after each path
+		std::vector<std::pair<NodeID, z3::expr>> vars;	///< callee ValVars (summary context) used by the summary
+		std::vector<std::pair<u32_t, z3::expr>> reads;	///< (address, select(loc2ValMap, address)) read by the summary
+
+		FunctionSummary()
+		: valid(false) {
+		}
+	};
+
+	class FunctionSummaryMgr {
+	 public:
+		/// Summaries used by sse
+		FunctionSummaryMgr(SSE* sse);
+		~FunctionSummaryMgr();
+
+		/// Return the summary of the callee of call (after call has been translated by sse),
+		/// computed on first use, or nullptr if the callee cannot be summarized
+		const FunctionSummary* getSummary(const CallCFGEdge* call);
+
+		/// Add the summary to sse under its current (callee) calling context
+		void instantiate(const FunctionSummary& summary);
+
+		inline void setMaxSummaryPaths(u32_t paths) {
+			maxSummaryPaths = paths;
+		}
+
+		/// Statistics
+		///@{
+		inline u32_t getSummaryNum() const {
+			return summaryNum;
+		}
+		inline u32_t getInstantiationNum() const {
+			return instantiationNum;
+		}
+		///@}
+
+	 private:
+		/// (callee, (formal parameter, bound address) of the pointer parameters)
+		typedef std::pair<const FunObjVar*, std::vector<std::pair<NodeID, u32_t>>> SummaryKey;
+
+		/// Compute the summary of the callee entered by call
+		void computeSummary(const CallCFGEdge* call, const SummaryKey& key, FunctionSummary& summary);
+
+		/// Collect the paths from node to the exit of the callee, return false if the callee cannot be summarized
+		/// (e.g., it makes a call or has an assertion, which must be checked in its calling context)
+		bool collectPaths(const ICFGNode* node, Set<const ICFGEdge*>& onPath, u32_t base, FunctionSummary& summary);
+
+		/// Translate the collected paths into the context of sse and find their ValVars and memory reads
+		void translateSummary(FunctionSummary& summary);
+
+		SSE* sse;
+		std::unique_ptr<SSE> summarizer;	///< SSE computing the summaries, created on first use
+		std::map<SummaryKey, FunctionSummary> summaries;
+		u32_t maxSummaryPaths;
+		u32_t summaryNum;
+		u32_t instantiationNum;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_FUNCTIONSUMMARY_H
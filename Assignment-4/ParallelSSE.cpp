@@ -0,0 +1,276 @@
+//===- ParallelSSE.cpp -- Work-stealing parallel static symbolic execution --//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Work-stealing parallel static symbolic execution
+ */
+
+#include "ParallelSSE.h"
+#include <algorithm>
+
+using namespace SVF;
+using namespace SVFUtil;
+
+void ParallelSSE::TaskDeque::pushBottom(Task&& task) {
+	std::lock_guard<std::mutex> lock(mtx);
+	tasks.push_back(std::move(task));
+}
+
+bool ParallelSSE::TaskDeque::popBottom(Task& task) {
+	std::lock_guard<std::mutex> lock(mtx);
+	if (tasks.empty())
+		return false;
+	task = std::move(tasks.back());
+	tasks.pop_back();
+	return true;
+}
+
+bool ParallelSSE::TaskDeque::popTop(Task& task) {
+	std::lock_guard<std::mutex> lock(mtx);
+	if (tasks.empty())
+		return false;
+	task = std::move(tasks.front());
+	tasks.pop_front();
+	return true;
+}
+
+/// The z3 contexts are all created here, on the calling thread
+ParallelSSE::ParallelSSE(SVFIR* s, ICFG* i, u32_t numOfThreads, Z3Mgr::ValueDomain domain)
+: svfir(s)
+, icfg(i)
+, pendingTasks(0)
+, pushedTasks(0)
+, pathNum(0)
+, stealNum(0) {
+	if (numOfThreads == 0)
+		numOfThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (u32_t id = 0; id < numOfThreads; id++) {
+		workers.emplace_back(new Worker());
+		workers.back()->sse.reset(new WorkerSSE(s, i, domain));
+		workers.back()->sse->setMultiSink(true);
+	}
+}
+
+void ParallelSSE::setSolverLimits(u32_t timeoutMs, u32_t rlimit, u32_t maxMemoryMB) {
+	for (auto& w : workers)
+		w->sse->setSolverLimits(timeoutMs, rlimit, maxMemoryMB);
+}
+
+void ParallelSSE::setSlicing(bool slice) {
+	for (auto& w : workers)
+		w->sse->setSlicing(slice);
+}
+
+void ParallelSSE::analyse() {
+	for (auto& w : workers) {
+		while (!w->path.empty())
+			popEdge(*w);
+		w->sse->resetSolver();
+		w->sse->selectSlice(nullptr);
+		w->sse->clearVerdicts();
+		w->solverMs = w->sse->getBudget().getSolverTime();
+		w->paths = 0;
+		w->steals = 0;
+	}
+
+	const ICFGNode* src = icfg->getGlobalICFGNode();
+	const IntraCFGEdge startEdge(nullptr, const_cast<ICFGNode*>(src));
+	Task init;
+	init.path.push_back(&startEdge);
+	pendingTasks = 1;
+	budget.start();
+	workers[0]->deque.pushBottom(std::move(init));
+
+	std::vector<std::thread> threads;
+	for (u32_t id = 0; id < workers.size(); id++)
+		threads.emplace_back(&ParallelSSE::run, this, id);
+	for (std::thread& t : threads)
+		t.join();
+
+	/// startEdge goes out of scope, so no worker may keep it on its solver stack
+	pathNum = 0;
+	stealNum = 0;
+	for (auto& w : workers) {
+		while (!w->path.empty())
+			popEdge(*w);
+		pathNum += w->paths;
+		stealNum += w->steals;
+	}
+	mergeVerdicts();
+	if (budget.isPartial())
+		SVFUtil::outs() << SVFUtil::wrnMsg(budget.toString()) << "\n";
+	reportVerdicts();
+}
+
+/// A task only finishes after pushing its successors, so no task is left once pendingTasks drops to zero.
+/// An idle worker sleeps until a task is pushed (pushedTasks changes) or the last task finishes
+void ParallelSSE::run(u32_t id) {
+	Worker& w = *workers[id];
+	Task task;
+	while (true) {
+		u64_t pushed = pushedTasks;
+		if (takeTask(id, task)) {
+			explore(w, task);
+			if (--pendingTasks == 0) {
+				std::lock_guard<std::mutex> lock(idleMtx);
+				idle.notify_all();
+			}
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(idleMtx);
+		idle.wait(lock, [&]() {
+			return pendingTasks == 0 || pushedTasks != pushed;
+		});
+		if (pendingTasks == 0)
+			break;
+	}
+}
+
+void ParallelSSE::pushTask(Worker& w, Task&& task) {
+	pendingTasks++;
+	w.deque.pushBottom(std::move(task));
+	{
+		std::lock_guard<std::mutex> lock(idleMtx);
+		pushedTasks++;
+	}
+	idle.notify_one();
+}
+
+bool ParallelSSE::takeTask(u32_t id, Task& task) {
+	if (workers[id]->deque.popBottom(task))
+		return true;
+	for (u32_t i = 1; i < workers.size(); i++) {
+		if (workers[(id + i) % workers.size()]->deque.popTop(task)) {
+			workers[id]->steals++;
+			return true;
+		}
+	}
+	return false;
+}
+
+/// The successors other than the first one are pushed in reverse order, so the owner pops them in ICFG order.
+/// Once the budget ran out, the remaining tasks are taken and dropped
+void ParallelSSE::explore(Worker& w, Task& task) {
+	if (isExhausted() || syncPath(w, task.path) == false)
+		return;
+	while (true) {
+		const ICFGNode* node = w.path.back()->getDstNode();
+		if (w.sse->isAssertion(node)) {
+			w.paths++;
+			countPath();
+			w.sse->assertchecking(node);
+		}
+		if (canDescend(w) == false)
+			return;
+
+		std::vector<const ICFGEdge*> succs;
+		for (const ICFGEdge* edge : node->getOutEdges()) {
+			SSE::CtxID callstack;
+			if (nextCallStack(w, edge, callstack) && canVisit(w, edge))
+				succs.push_back(edge);
+		}
+		if (succs.empty())
+			return;
+
+		for (u32_t i = succs.size() - 1; i > 0; i--) {
+			Task t;
+			t.path = w.path;
+			t.path.push_back(succs[i]);
+			pushTask(w, std::move(t));
+		}
+		if (pushEdge(w, succs[0]) == false)
+			return;
+	}
+}
+
+/// Tasks popped from the own deque share most of their prefix with the current path, so only a few edges are
+/// (re-)translated; a stolen task is translated from the longest common prefix
+bool ParallelSSE::syncPath(Worker& w, const Path& prefix) {
+	u32_t common = 0;
+	while (common < w.path.size() && common < prefix.size() && w.path[common] == prefix[common])
+		common++;
+	while (w.path.size() > common)
+		popEdge(w);
+	for (u32_t i = common; i < prefix.size(); i++) {
+		if (pushEdge(w, prefix[i]) == false)
+			return false;
+	}
+	return true;
+}
+
+/// An infeasible edge is popped again right away, so the path of a worker is always feasible
+bool ParallelSSE::pushEdge(Worker& w, const ICFGEdge* edge) {
+	SSE::CtxID before = w.callstacks.empty() ? CallingCtxTrie::EmptyCtx : w.callstacks.back();
+	SSE::CtxID after;
+	bool matched = nextCallStack(w, edge, after);
+	assert(matched && "return edge does not match the call stack?");
+	(void) matched;
+	w.path.push_back(edge);
+	w.callstacks.push_back(after);
+	w.visitCounts[std::make_pair(edge, before)]++;
+	if (w.sse->pushEdge(edge) == false) {
+		popEdge(w);
+		return false;
+	}
+	return true;
+}
+
+void ParallelSSE::popEdge(Worker& w) {
+	assert(!w.path.empty() && "popEdge on an empty path?");
+	SSE::CtxID before = w.callstacks.size() > 1 ? w.callstacks[w.callstacks.size() - 2] : CallingCtxTrie::EmptyCtx;
+	auto it = w.visitCounts.find(std::make_pair(w.path.back(), before));
+	if (--it->second == 0)
+		w.visitCounts.erase(it);
+	w.path.pop_back();
+	w.callstacks.pop_back();
+	w.sse->popEdge();
+}
+
+bool ParallelSSE::canDescend(Worker& w) {
+	double solverMs = w.sse->getBudget().getSolverTime();
+	std::lock_guard<std::mutex> lock(budgetMtx);
+	budget.addSolverTime(solverMs - w.solverMs);
+	w.solverMs = solverMs;
+	return budget.canDescend(w.path.size());
+}
+
+void ParallelSSE::countPath() {
+	std::lock_guard<std::mutex> lock(budgetMtx);
+	budget.countPath();
+}
+
+bool ParallelSSE::isExhausted() {
+	std::lock_guard<std::mutex> lock(budgetMtx);
+	return budget.isExhausted();
+}
+
+/// The verdicts are folded in worker order, and the fold does not depend on which worker checked which path
+void ParallelSSE::mergeVerdicts() {
+	verdicts.clear();
+	for (auto& w : workers)
+		verdicts.merge(w->sse->getVerdicts());
+	const std::set<const ICFGNode*>& sinks = workers[0]->sse->identifySinks();
+	if (budget.isPartial()) {
+		for (const ICFGNode* sink : sinks)
+			verdicts.markPartial(sink);
+	}
+	verdicts.finish(sinks);
+}
@@ -0,0 +1,210 @@
+//===- ParallelSSE.h -- Work-stealing parallel static symbolic execution --//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Work-stealing parallel static symbolic execution
+ *
+ * Each worker thread owns an SSE (and so its own Z3SSEMgr and z3::context) and a deque of
+ * unexplored branch states. A worker follows one successor of each node itself and pushes the
+ * others onto the bottom of its deque; idle workers steal from the top of the other deques, and sleep
+ * while there is nothing to steal.
+ * A task only carries its path prefix: the worker (re-)translates the edges that are not already
+ * on its own solver stack with SSE::pushEdge, which also re-interns the calling contexts in the
+ * worker's context trie. All assertions are checked in place (as in SSE's multi-sink mode) and
+ * the per-sink verdicts of all workers are merged in ICFGNode ID order at the end.
+ * The workers share one ExplorationBudget (getBudget): loops are unrolled up to its bounds, paths stop
+ * at its depth bound and no task is explored once it ran out, the verdicts are then partial.
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_PARALLELSSE_H
+#define SOFTWARE_SECURITY_ANALYSIS_PARALLELSSE_H
+
+#include "Assignment-4.h"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace SVF {
+
+	class ParallelSSE {
+	 public:
+		typedef std::vector<const ICFGEdge*> Path;
+
+		/// Merged result of checking one assertion on all paths reaching it
+		typedef AssertionVerdict SinkVerdict;
+		typedef VerdictTable::Verdicts SinkVerdicts;
+
+		/// Constructor, numOfThreads workers are created (0 means one per hardware thread)
+		ParallelSSE(SVFIR* s, ICFG* i, u32_t numOfThreads = 0,
+		            Z3Mgr::ValueDomain domain = (Z3Mgr::ValueDomain) Z3_BV_WIDTH);
+
+		/// Explore all paths from the program entry in parallel, then merge and report the verdicts
+		void analyse();
+
+		/// Print the merged verdict of each assertion
+		inline void reportVerdicts() const {
+			verdicts.print();
+		}
+
+		inline const SinkVerdicts& getVerdicts() const {
+			return verdicts.getVerdicts();
+		}
+
+		/// Write the merged verdicts as a JSON report, return false if the file cannot be written
+		inline bool writeReport(const std::string& fileName) const {
+			return verdicts.writeReport(fileName);
+		}
+
+		inline u32_t getThreadNum() const {
+			return workers.size();
+		}
+
+		/// Number of feasible entry-to-assertion paths checked by the last analyse
+		inline u64_t getPathNum() const {
+			return pathNum;
+		}
+
+		/// Number of tasks taken from the deque of another worker by the last analyse
+		inline u64_t getStealNum() const {
+			return stealNum;
+		}
+
+		/// Per-query solver limits of every worker (0 means unbounded), see Z3Mgr
+		void setSolverLimits(u32_t timeoutMs, u32_t rlimit, u32_t maxMemoryMB);
+
+		/// Assertion-directed slicing of every worker, on the union of the slices of all assertions (see SSE::setSlicing)
+		void setSlicing(bool slice);
+
+		/// Loop unrolling bounds and budgets of analyse, shared by all workers
+		inline ExplorationBudget& getBudget() {
+			return budget;
+		}
+
+	 private:
+		/// An unexplored branch state: the path prefix ending with the edge to explore next
+		struct Task {
+			Path path;
+		};
+
+		/// Deque of a worker, the owner works at the bottom (LIFO, for solver stack reuse)
+		/// and thieves take from the top (the shortest, i.e., usually largest, subtrees)
+		class TaskDeque {
+		 public:
+			void pushBottom(Task&& task);
+			bool popBottom(Task& task);
+			bool popTop(Task& task);
+
+		 private:
+			std::deque<Task> tasks;
+			std::mutex mtx;
+		};
+
+		/// SSE of a worker thread: records the assertion results (in batch mode) instead of printing them
+		class WorkerSSE : public SSE {
+		 public:
+			WorkerSSE(SVFIR* s, ICFG* i, Z3Mgr::ValueDomain domain)
+			: SSE(s, i, domain) {
+				identifySinks();
+				setBatchMode(true);
+			}
+
+			/// Return true if node is an assertion
+			inline bool isAssertion(const ICFGNode* node) const {
+				return isSink(node, nullptr);
+			}
+		};
+
+		/// A worker: its SSE, its deque and the path currently translated on its solver stack
+		struct Worker {
+			std::unique_ptr<WorkerSSE> sse;
+			TaskDeque deque;
+			Path path;					///< edges pushed with SSE::pushEdge
+			std::vector<SSE::CtxID> callstacks;		///< traversal call stack after each edge of path
+			Map<SSE::ICFGEdgeStackPair, u32_t> visitCounts;	///< times each (edge, call stack) pair is on path
+			double solverMs;				///< solver time of the worker already accounted to the budget
+			u64_t paths;
+			u64_t steals;
+		};
+
+		/// Thread body: run tasks from the own deque, steal when it is empty, stop when no task is left
+		void run(u32_t id);
+
+		/// Push a task onto the deque of w and wake up an idle worker
+		void pushTask(Worker& w, Task&& task);
+
+		/// Take a task, from the own deque first and then round-robin from the others
+		bool takeTask(u32_t id, Task& task);
+
+		/// Follow a task depth-first, spawning the other successors of each node as tasks
+		void explore(Worker& w, Task& task);
+
+		/// Make the worker's solver stack match the prefix, return false if the prefix is infeasible
+		bool syncPath(Worker& w, const Path& prefix);
+
+		/// Push/pop one edge on the worker's path and solver stack
+		///@{
+		bool pushEdge(Worker& w, const ICFGEdge* edge);
+		void popEdge(Worker& w);
+		///@}
+
+		/// Set callstack to the call stack after following edge from the end of the worker's path (see SSE::nextCallStack)
+		inline bool nextCallStack(Worker& w, const ICFGEdge* edge, SSE::CtxID& callstack) {
+			SSE::CtxID cur = w.callstacks.empty() ? CallingCtxTrie::EmptyCtx : w.callstacks.back();
+			return w.sse->nextCallStack(cur, edge, callstack);
+		}
+
+		/// Return true if edge may be taken again from the end of the worker's path (see SSE::visitEdge)
+		inline bool canVisit(const Worker& w, const ICFGEdge* edge) const {
+			auto it = w.visitCounts.find(std::make_pair(edge, w.callstacks.back()));
+			return it == w.visitCounts.end() || it->second < budget.getLoopUnrollBound(edge->getSrcNode()->getFun());
+		}
+
+		/// The shared budget, accessed under budgetMtx
+		///@{
+		/// Account the solver time of the worker, return false if its path must not be extended (see SSE::canDescend)
+		bool canDescend(Worker& w);
+		void countPath();
+		bool isExhausted();
+		///@}
+
+		/// Merge the verdicts of all workers, independently of the interleaving of the threads
+		void mergeVerdicts();
+
+		SVFIR* svfir;
+		ICFG* icfg;
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::atomic<u64_t> pendingTasks;	///< tasks pushed but not yet finished
+		std::atomic<u64_t> pushedTasks;	///< tasks pushed so far, changed under idleMtx
+		std::mutex idleMtx;
+		std::condition_variable idle;	///< signalled when a task is pushed or pendingTasks drops to zero
+		VerdictTable verdicts;
+		ExplorationBudget budget;
+		std::mutex budgetMtx;
+		u64_t pathNum;
+		u64_t stealNum;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_PARALLELSSE_H
@@ -0,0 +1,143 @@
+//===- ScheduledSSE.cpp -- Static symbolic execution driven by a search strategy --//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Static symbolic execution driven by a search strategy
+ */
+
+#include "ScheduledSSE.h"
+
+using namespace SVF;
+using namespace SVFUtil;
+
+ScheduledSSE::ScheduledSSE(SVFIR* s, ICFG* i, Z3Mgr::ValueDomain domain)
+: SSE(s, i, domain)
+, strategy(new DFSStrategy())
+, nextStateId(0)
+, stateNum(0)
+, firstViolation(0) {
+}
+
+void ScheduledSSE::analyse() {
+	identifySinks();
+	selectSlice(nullptr);
+	budget.start();
+	verdicts.clear();
+	stateNum = 0;
+	firstViolation = 0;
+	strategy->clear();
+	strategy->initialize(getICFG(), sinks);
+
+	const ICFGNode* src = getICFG()->getGlobalICFGNode();
+	const IntraCFGEdge* startEdge = arena.create<IntraCFGEdge>(nullptr, const_cast<ICFGNode*>(src));
+	SearchState state{arena.extend(nullptr, startEdge), src, nextStateId, nextStateId};
+	nextStateId++;
+	strategy->add(std::move(state));
+	while (!budget.isExhausted() && strategy->next(state)) {
+		stateNum++;
+		expand(state);
+	}
+
+	/// startEdge and the paths of the states are released with the arena by resetSolver, so neither the path nor the strategy may keep them
+	while (!path.empty())
+		popPathEdge();
+	strategy->clear();
+	resetSolver();
+	getPathConsumer()->finish();
+	if (budget.isPartial())
+		SVFUtil::outs() << SVFUtil::wrnMsg(budget.toString()) << "\n";
+	finishVerdicts(budget.isPartial());
+}
+
+bool ScheduledSSE::reportAssertion(const ICFGNode* inode, Z3Mgr::CheckResult res) {
+	if (res == Z3Mgr::Sat && firstViolation == 0)
+		firstViolation = stateNum;
+	return SSE::reportAssertion(inode, res);
+}
+
+/// Successors exceeding the loop unroll bound are not added
+void ScheduledSSE::expand(SearchState& state) {
+	arena.getPath(state.tail, prefix);
+	if (syncPath(prefix) == false)
+		return;
+	const ICFGNode* node = state.getNode();
+	strategy->onExpand(node);
+	if (isSink(node, nullptr)) {
+		budget.countPath();
+		consumePath();
+		assertchecking(node);
+	}
+	if (canDescend() == false)
+		return;
+
+	for (const ICFGEdge* edge : node->getOutEdges()) {
+		CtxID next;
+		if (nextCallStack(callstack, edge, next) == false)
+			continue;
+		auto it = visitCounts.find(ICFGEdgeStackPair(edge, callstack));
+		if (it != visitCounts.end() && it->second >= budget.getLoopUnrollBound(edge->getSrcNode()->getFun()))
+			continue;
+		SearchState succ{arena.extend(state.tail, edge), edge->getDstNode(), nextStateId++, state.id};
+		strategy->add(std::move(succ));
+	}
+}
+
+/// Consecutive states of DFS share all but their last edge, so only a few edges are (re-)translated
+bool ScheduledSSE::syncPath(const std::vector<const ICFGEdge*>& prefix) {
+	u32_t common = 0;
+	while (common < path.size() && common < prefix.size() && path[common] == prefix[common])
+		common++;
+	while (path.size() > common)
+		popPathEdge();
+	for (u32_t i = common; i < prefix.size(); i++) {
+		if (pushPathEdge(prefix[i]) == false)
+			return false;
+	}
+	return true;
+}
+
+/// An infeasible edge is popped again right away, so the translated path is always feasible
+bool ScheduledSSE::pushPathEdge(const ICFGEdge* edge) {
+	CtxID next;
+	bool matched = nextCallStack(callstack, edge, next);
+	assert(matched && "return edge does not match the call stack?");
+	(void) matched;
+	bool taken = visitEdge(edge);
+	assert(taken && "edge taken beyond its loop unroll bound?");
+	(void) taken;
+	callstacks.push_back(callstack);
+	path.push_back(edge);
+	callstack = next;
+	if (pushEdge(edge) == false) {
+		popPathEdge();
+		return false;
+	}
+	return true;
+}
+
+void ScheduledSSE::popPathEdge() {
+	assert(!path.empty() && "popPathEdge on an empty path?");
+	callstack = callstacks.back();
+	callstacks.pop_back();
+	unvisitEdge(path.back());
+	path.pop_back();
+	popEdge();
+}
@@ -0,0 +1,93 @@
+//===- ScheduledSSE.h -- Static symbolic execution driven by a search strategy --//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Static symbolic execution driven by a search strategy
+ *
+ * Instead of the recursive traversal of reachability, the exploration loop repeatedly takes a pending
+ * state (a path prefix) from a SearchStrategy, translates it incrementally (only the edges after the
+ * prefix shared with the previous state are re-translated), checks the assertion at its node (if any) and
+ * adds its successors back to the strategy. Every assertion reached is checked, as in multi-sink mode.
+ * Loops are unrolled and the exploration is bounded by the ExplorationBudget of the SSE.
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_SCHEDULEDSSE_H
+#define SOFTWARE_SECURITY_ANALYSIS_SCHEDULEDSSE_H
+
+#include "Assignment-4.h"
+#include "SearchStrategy.h"
+
+namespace SVF {
+
+	class ScheduledSSE : public SSE {
+	 public:
+		/// Constructor, the exploration is depth-first unless another strategy is set
+		ScheduledSSE(SVFIR* s, ICFG* i, Z3Mgr::ValueDomain domain = (Z3Mgr::ValueDomain) Z3_BV_WIDTH);
+
+		/// Explore the paths from the program entry in the order of the search strategy
+		virtual void analyse() override;
+
+		/// Set the search strategy
+		inline void setSearchStrategy(std::unique_ptr<SearchStrategy> s) {
+			strategy = std::move(s);
+		}
+		inline SearchStrategy& getSearchStrategy() {
+			return *strategy;
+		}
+
+		/// Statistics of the last analyse
+		///@{
+		/// Number of states expanded
+		inline u64_t getStateNum() const {
+			return stateNum;
+		}
+		/// Number of states expanded before the first violated assertion (0 if none was found)
+		inline u64_t getFirstViolationStateNum() const {
+			return firstViolation;
+		}
+		///@}
+
+		virtual bool reportAssertion(const ICFGNode* inode, Z3Mgr::CheckResult res) override;
+
+	 private:
+		/// Translate the state and add its successors to the strategy
+		void expand(SearchState& state);
+
+		/// Make the path translated on the solver stack match the prefix, return false if the prefix is infeasible
+		bool syncPath(const std::vector<const ICFGEdge*>& prefix);
+
+		/// Push/pop one edge on the path, the call stack and the solver stack
+		///@{
+		bool pushPathEdge(const ICFGEdge* edge);
+		void popPathEdge();
+		///@}
+
+		std::unique_ptr<SearchStrategy> strategy;
+		std::vector<CtxID> callstacks;	///< call stack before each edge of path
+		std::vector<const ICFGEdge*> prefix;	///< buffer for the path of the state being expanded
+		u64_t nextStateId;
+		u64_t stateNum;
+		u64_t firstViolation;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_SCHEDULEDSSE_H
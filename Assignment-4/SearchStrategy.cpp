@@ -0,0 +1,157 @@
+//===- SearchStrategy.cpp -- Search strategies of scheduled SSE ----------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Search strategies of scheduled SSE
+ */
+
+#include "SearchStrategy.h"
+
+using namespace SVF;
+using namespace SVFUtil;
+
+/// Multi-source BFS on the reversed ICFG
+void SearchStrategy::computeSinkDistances(ICFG* icfg, const std::set<const ICFGNode*>& sinks, Map<const ICFGNode*, u32_t>& distances) {
+	distances.clear();
+	std::deque<const ICFGNode*> worklist;
+	for (const ICFGNode* sink : sinks) {
+		distances[sink] = 0;
+		worklist.push_back(sink);
+	}
+	while (!worklist.empty()) {
+		const ICFGNode* node = worklist.front();
+		worklist.pop_front();
+		u32_t dist = distances[node] + 1;
+		for (const ICFGEdge* edge : node->getInEdges()) {
+			if (distances.emplace(edge->getSrcNode(), dist).second)
+				worklist.push_back(edge->getSrcNode());
+		}
+	}
+}
+
+/// The successors of a state are added in ICFG order and pushed in reverse, so they are expanded in ICFG order
+void DFSStrategy::add(SearchState&& state) {
+	pending.push_back(std::move(state));
+}
+
+bool DFSStrategy::next(SearchState& state) {
+	while (!pending.empty()) {
+		states.push_back(std::move(pending.back()));
+		pending.pop_back();
+	}
+	if (states.empty())
+		return false;
+	state = std::move(states.back());
+	states.pop_back();
+	return true;
+}
+
+bool BFSStrategy::next(SearchState& state) {
+	if (states.empty())
+		return false;
+	state = std::move(states.front());
+	states.pop_front();
+	return true;
+}
+
+void RandomPathStrategy::clear() {
+	root.reset(new TreeNode{nullptr, {}, 0, false, SearchState{nullptr, nullptr, 0, 0}, 0});
+	nodes.clear();
+	lastTaken = nullptr;
+}
+
+/// The initial state (and any state whose parent is unknown) hangs off the root
+void RandomPathStrategy::add(SearchState&& state) {
+	auto it = nodes.find(state.parent);
+	TreeNode* parent = (it == nodes.end() || state.parent == state.id) ? root.get() : it->second;
+	u64_t id = state.id;
+	parent->children.emplace_back(new TreeNode{parent, {}, 0, true, std::move(state), id});
+	nodes[id] = parent->children.back().get();
+	for (TreeNode* n = parent; n; n = n->parent)
+		n->pending++;
+	parent->children.back()->pending = 1;
+}
+
+/// Each child with pending states is equally likely, so a state at depth d is taken with probability
+/// 1/(product of the branching factors above it)
+bool RandomPathStrategy::next(SearchState& state) {
+	if (lastTaken) {
+		prune(lastTaken);
+		lastTaken = nullptr;
+	}
+	if (root->pending == 0)
+		return false;
+	TreeNode* node = root.get();
+	while (!node->hasState) {
+		std::vector<TreeNode*> candidates;
+		for (const std::unique_ptr<TreeNode>& child : node->children) {
+			if (child->pending > 0)
+				candidates.push_back(child.get());
+		}
+		assert(!candidates.empty() && "pending count out of sync?");
+		std::uniform_int_distribution<u32_t> pick(0, candidates.size() - 1);
+		node = candidates[pick(rng)];
+	}
+	state = std::move(node->state);
+	node->hasState = false;
+	for (TreeNode* n = node; n; n = n->parent)
+		n->pending--;
+	lastTaken = node;
+	return true;
+}
+
+/// Expanded nodes without pending states left are removed bottom-up
+void RandomPathStrategy::prune(TreeNode* node) {
+	while (node != root.get() && node->pending == 0) {
+		TreeNode* parent = node->parent;
+		nodes.erase(node->id);
+		for (auto it = parent->children.begin(); it != parent->children.end(); ++it) {
+			if (it->get() == node) {
+				parent->children.erase(it);
+				break;
+			}
+		}
+		node = parent;
+	}
+}
+
+void PriorityStrategy::add(SearchState&& state) {
+	Entry entry{getPriority(state), order++, state};
+	queue.push(entry);
+}
+
+/// A priority may have grown since the state was added (e.g., its node got covered), so the best
+/// state is re-queued until its current priority is still the best
+bool PriorityStrategy::next(SearchState& state) {
+	while (!queue.empty()) {
+		Entry entry = queue.top();
+		queue.pop();
+		Priority current = getPriority(entry.state);
+		if (current != entry.priority && !queue.empty() && queue.top().priority < current) {
+			entry.priority = current;
+			queue.push(entry);
+			continue;
+		}
+		state = entry.state;
+		return true;
+	}
+	return false;
+}
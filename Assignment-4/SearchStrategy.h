@@ -0,0 +1,248 @@
+//===- SearchStrategy.h -- Search strategies of scheduled SSE ------------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Search strategies of scheduled SSE
+ *
+ * A search strategy holds the pending states of the exploration (path prefixes not yet expanded)
+ * and decides which one is expanded next:
+ * DFS and BFS, random-path (a random walk from the root of the tree of expanded states, as in KLEE,
+ * which favours states close to the root without starving deep ones), distance-guided (the state whose
+ * next node is closest to an assertion on the ICFG) and coverage-guided (the state whose next node has
+ * been expanded the fewest times, then the closest to an assertion).
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_SEARCHSTRATEGY_H
+#define SOFTWARE_SECURITY_ANALYSIS_SEARCHSTRATEGY_H
+
+#include "SVFIR/SVFIR.h"
+#include "PathArena.h"
+#include <climits>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <random>
+
+namespace SVF {
+
+	/// A pending state of the exploration. Its path prefix is shared with the states it was expanded from
+	/// in the PathArena of the exploration, so a state is a few words whatever the length of its path
+	struct SearchState {
+		const PathArena::PathNode* tail;	///< path prefix, ending with the edge to follow next
+		const ICFGNode* node;	///< destination of that edge
+		u64_t id;
+		u64_t parent;	///< id of the state this one was expanded from (its own id for the initial state)
+
+		/// Node reached by the state
+		inline const ICFGNode* getNode() const {
+			return node;
+		}
+		inline u32_t getDepth() const {
+			return tail->depth;
+		}
+	};
+
+	class SearchStrategy {
+	 public:
+		virtual ~SearchStrategy() {
+		}
+
+		/// Called before an exploration with the assertions to reach
+		virtual void initialize(ICFG* icfg, const std::set<const ICFGNode*>& sinks) {
+		}
+
+		/// Add a pending state
+		virtual void add(SearchState&& state) = 0;
+
+		/// Remove the next state to expand into state, return false if there is none
+		virtual bool next(SearchState& state) = 0;
+
+		/// Called when a state is expanded at node
+		virtual void onExpand(const ICFGNode* node) {
+		}
+
+		virtual bool empty() const = 0;
+		virtual void clear() = 0;
+		virtual const char* getName() const = 0;
+
+		/// Shortest distance (in ICFG edges, ignoring calling contexts) from each node to an assertion,
+		/// nodes that cannot reach any assertion are absent
+		static void computeSinkDistances(ICFG* icfg, const std::set<const ICFGNode*>& sinks, Map<const ICFGNode*, u32_t>& distances);
+	};
+
+	class DFSStrategy : public SearchStrategy {
+	 public:
+		virtual void add(SearchState&& state) override;
+		virtual bool next(SearchState& state) override;
+		virtual bool empty() const override {
+			return states.empty() && pending.empty();
+		}
+		virtual void clear() override {
+			states.clear();
+			pending.clear();
+		}
+		virtual const char* getName() const override {
+			return "dfs";
+		}
+
+	 private:
+		std::vector<SearchState> states;
+		std::vector<SearchState> pending;	///< successors of the last expanded state, in ICFG order
+	};
+
+	class BFSStrategy : public SearchStrategy {
+	 public:
+		virtual void add(SearchState&& state) override {
+			states.push_back(std::move(state));
+		}
+		virtual bool next(SearchState& state) override;
+		virtual bool empty() const override {
+			return states.empty();
+		}
+		virtual void clear() override {
+			states.clear();
+		}
+		virtual const char* getName() const override {
+			return "bfs";
+		}
+
+	 private:
+		std::deque<SearchState> states;
+	};
+
+	class RandomPathStrategy : public SearchStrategy {
+	 public:
+		RandomPathStrategy(u32_t seed = 0)
+		: rng(seed)
+		, lastTaken(nullptr) {
+			clear();
+		}
+		virtual void add(SearchState&& state) override;
+		virtual bool next(SearchState& state) override;
+		virtual bool empty() const override {
+			return root->pending == 0;
+		}
+		virtual void clear() override;
+		virtual const char* getName() const override {
+			return "random-path";
+		}
+
+	 private:
+		/// Node of the tree of expanded states, a leaf holding a state is pending
+		struct TreeNode {
+			TreeNode* parent;
+			std::vector<std::unique_ptr<TreeNode>> children;
+			u32_t pending;	///< pending states in the subtree
+			bool hasState;
+			SearchState state;
+			u64_t id;
+		};
+
+		/// Remove node from the tree if its subtree holds no pending state
+		void prune(TreeNode* node);
+
+		std::mt19937 rng;
+		std::unique_ptr<TreeNode> root;
+		Map<u64_t, TreeNode*> nodes;	///< state id -> tree node
+		TreeNode* lastTaken;	///< node of the last returned state, which may still get successors
+	};
+
+	/// Best-first search on a priority, recomputed lazily when a state is taken
+	class PriorityStrategy : public SearchStrategy {
+	 public:
+		typedef std::pair<u32_t, u32_t> Priority;	///< smaller is better
+
+		virtual void add(SearchState&& state) override;
+		virtual bool next(SearchState& state) override;
+		virtual bool empty() const override {
+			return queue.empty();
+		}
+		virtual void clear() override {
+			queue = std::priority_queue<Entry>();
+		}
+
+	 protected:
+		virtual Priority getPriority(const SearchState& state) = 0;
+
+		/// Distance from node to the closest assertion, UINT_MAX if unreachable
+		inline u32_t getDistance(const ICFGNode* node) const {
+			auto it = distances.find(node);
+			return it == distances.end() ? UINT_MAX : it->second;
+		}
+
+		Map<const ICFGNode*, u32_t> distances;
+
+	 private:
+		struct Entry {
+			Priority priority;
+			u64_t order;	///< insertion order, to break ties deterministically (FIFO)
+			SearchState state;
+			inline bool operator<(const Entry& other) const {
+				return other.priority < priority || (other.priority == priority && other.order < order);
+			}
+		};
+		std::priority_queue<Entry> queue;
+		u64_t order = 0;
+	};
+
+	class DistanceGuidedStrategy : public PriorityStrategy {
+	 public:
+		virtual void initialize(ICFG* icfg, const std::set<const ICFGNode*>& sinks) override {
+			computeSinkDistances(icfg, sinks, distances);
+		}
+		virtual const char* getName() const override {
+			return "distance";
+		}
+
+	 protected:
+		/// Closest to an assertion first, then deepest (to finish the paths close to an assertion)
+		virtual Priority getPriority(const SearchState& state) override {
+			return Priority(getDistance(state.getNode()), UINT_MAX - state.getDepth());
+		}
+	};
+
+	class CoverageGuidedStrategy : public PriorityStrategy {
+	 public:
+		virtual void initialize(ICFG* icfg, const std::set<const ICFGNode*>& sinks) override {
+			computeSinkDistances(icfg, sinks, distances);
+			covered.clear();
+		}
+		virtual void onExpand(const ICFGNode* node) override {
+			covered[node]++;
+		}
+		virtual const char* getName() const override {
+			return "coverage";
+		}
+
+	 protected:
+		/// Least expanded node first, then closest to an assertion
+		virtual Priority getPriority(const SearchState& state) override {
+			auto it = covered.find(state.getNode());
+			return Priority(it == covered.end() ? 0 : it->second, getDistance(state.getNode()));
+		}
+
+	 private:
+		Map<const ICFGNode*, u32_t> covered;	///< times each node has been expanded
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_SEARCHSTRATEGY_H
@@ -0,0 +1,259 @@
+//===- StateMergingSSE.cpp -- Static symbolic execution with state merging --//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Static symbolic execution with state merging at ICFG join points
+ */
+
+#include "StateMergingSSE.h"
+
+using namespace SVF;
+using namespace SVFUtil;
+
+StateMergingSSE::StateMergingSSE(SVFIR* s, ICFG* i, Z3Mgr::ValueDomain domain)
+: SSE(s, i, domain)
+, guard(getCtx().bool_val(true))
+, recording(false)
+, stateMerging(true)
+, maxMergeDiff(16)
+, stateNum(0)
+, mergeNum(0) {
+}
+
+void StateMergingSSE::addToSolver(z3::expr e) {
+	SSE::addToSolver(e);
+	if (recording) {
+		guardedConstraints.push_back(z3::implies(guard, e));
+		recordPointer(e);
+	}
+}
+
+void StateMergingSSE::recordPointer(const z3::expr& e) {
+	if (!e.is_eq() || e.num_args() != 2)
+		return;
+	Z3SSEMgr* z3Mgr = getZ3SSEMgr();
+	for (u32_t i = 0; i < 2; i++) {
+		z3::expr var = e.arg(i);
+		int64_t val;
+		if (var.is_const() && !var.is_numeral() && z3Mgr->getConcreteValue(e.arg(1 - i), val) && z3Mgr->isVirtualMemAddress((u32_t) val)) {
+			pointers.emplace(var.id(), std::make_pair(var, (u32_t) val));
+			return;
+		}
+	}
+}
+
+/// The branch condition strengthens the guard instead of becoming a guarded constraint
+void StateMergingSSE::addBranchCondition(z3::expr cond) {
+	SSE::addToSolver(cond);
+	if (recording)
+		guard = guard && cond;
+}
+
+void StateMergingSSE::analyse() {
+	computeOrder();
+	identifySinks();
+	selectSlice(nullptr);
+	verdicts.clear();
+	stateNum = 0;
+	mergeNum = 0;
+
+	const ICFGNode* src = getICFG()->getGlobalICFGNode();
+	const IntraCFGEdge startEdge(nullptr, const_cast<ICFGNode*>(src));
+	State init{nullptr, CallingCtxTrie::EmptyCtx, CallingCtxTrie::EmptyCtx, getCtx().bool_val(true), {}, {}, {}, 1, {}, false};
+	expand(init, {&startEdge});
+
+	while (!worklist.empty()) {
+		auto it = worklist.begin();
+		std::vector<State> states = std::move(it->second);
+		worklist.erase(it);
+		for (const State& s : states) {
+			stateNum++;
+			step(s);
+		}
+	}
+	resetSolver();
+	getZ3SSEMgr()->setMemPartitions(Z3Mgr::MemPartitions());
+	finishVerdicts(false);
+}
+
+/// Iterative DFS, an edge to a node still on the DFS stack is a back edge
+void StateMergingSSE::computeOrder() {
+	struct Frame {
+		const ICFGNode* node;
+		std::vector<const ICFGEdge*> edges;
+		u32_t next;
+	};
+	rpo.clear();
+	backEdges.clear();
+	Set<const ICFGNode*> onStack;
+	std::vector<const ICFGNode*> postOrder;
+	std::vector<Frame> stack;
+
+	const ICFGNode* src = getICFG()->getGlobalICFGNode();
+	auto visit = [&](const ICFGNode* node) {
+		rpo[node] = 0;
+		onStack.insert(node);
+		stack.push_back(Frame{node, std::vector<const ICFGEdge*>(node->getOutEdges().begin(), node->getOutEdges().end()), 0});
+	};
+	visit(src);
+	while (!stack.empty()) {
+		Frame& f = stack.back();
+		if (f.next < f.edges.size()) {
+			const ICFGEdge* edge = f.edges[f.next++];
+			const ICFGNode* dst = edge->getDstNode();
+			if (onStack.find(dst) != onStack.end())
+				backEdges.insert(edge);
+			else if (rpo.find(dst) == rpo.end())
+				visit(dst);
+		}
+		else {
+			postOrder.push_back(f.node);
+			onStack.erase(f.node);
+			stack.pop_back();
+		}
+	}
+	for (u32_t i = 0; i < postOrder.size(); i++)
+		rpo[postOrder[i]] = postOrder.size() - 1 - i;
+}
+
+/// The guard of s is asserted in an outer scope, so the model (used to resolve pointers) and the assertion
+/// check only consider the paths of s. The guarded constraints are only added once that scope is popped.
+/// The definitions of s are restored before its edges are translated, and each successor keeps the definitions
+/// made by its edge, which are undone for the next edge. The pointer bindings of s are asserted again in the
+/// outer scope, so its pointers are resolved through them rather than concretized with a model
+void StateMergingSSE::expand(const State& s, const std::vector<const ICFGEdge*>& edges) {
+	Z3SSEMgr* z3Mgr = getZ3SSEMgr();
+	z3Mgr->setDefinitions(s.defs);
+	z3Mgr->setMemPartitions(s.mem);
+	z3Mgr->pushSolver();
+	z3Mgr->addToSolver(s.guard);
+	for (const auto& it : s.pointers)
+		z3Mgr->addToSolver(it.second.first == getZ3Val(it.second.second));
+	callingCtx = s.callingCtx;
+	if (s.node && isSink(s.node, nullptr))
+		assertchecking(s.node);
+
+	std::vector<State> succs;
+	for (const ICFGEdge* edge : edges) {
+		CtxID next;
+		if (nextCallStack(s.callstack, edge, next) == false)
+			continue;
+		ICFGEdgeStackPair loop(edge, s.callstack);
+		bool isBackEdge = backEdges.find(edge) != backEdges.end();
+		if (isBackEdge) {
+			auto it = s.loops.find(loop);
+			if (it != s.loops.end() && it->second >= budget.getLoopUnrollBound(edge->getSrcNode()->getFun()))
+				continue;
+		}
+
+		u32_t numOfConstraints = guardedConstraints.size();
+		u32_t defMark = z3Mgr->getDefinitionMark();
+		u32_t concretizations = z3Mgr->getConcretizationNum();
+		z3Mgr->pushSolver();
+		guard = s.guard;
+		pointers = s.pointers;
+		recording = true;
+		bool feasible = translateEdge(edge);
+		recording = false;
+		if (feasible) {
+			bool concretized = s.concretized || z3Mgr->getConcretizationNum() > concretizations;
+			succs.push_back(State{edge->getDstNode(), next, callingCtx, guard, z3Mgr->getMemPartitions(), s.loops, z3Mgr->getDefinitions(), s.paths, pointers, concretized});
+			if (isBackEdge)
+				succs.back().loops[loop]++;
+		}
+		else
+			guardedConstraints.erase(guardedConstraints.begin() + numOfConstraints, guardedConstraints.end());
+		z3Mgr->popSolver();
+		z3Mgr->undoDefinitions(defMark);
+		callingCtx = s.callingCtx;
+	}
+	z3Mgr->popSolver();
+
+	for (const z3::expr& c : guardedConstraints)
+		z3Mgr->addToSolver(c);
+	guardedConstraints.clear();
+	for (State& succ : succs)
+		enqueue(succ);
+}
+
+void StateMergingSSE::step(const State& s) {
+	std::vector<const ICFGEdge*> edges(s.node->getOutEdges().begin(), s.node->getOutEdges().end());
+	expand(s, edges);
+}
+
+void StateMergingSSE::enqueue(State& s) {
+	std::vector<State>& states = worklist[std::make_pair(rpo[s.node], s.callstack)];
+	for (State& other : states) {
+		if (other.callingCtx == s.callingCtx && other.loops == s.loops && canMerge(other, s) && isWorthMerging(other, s)) {
+			merge(other, s);
+			mergeNum++;
+			return;
+		}
+	}
+	states.push_back(std::move(s));
+}
+
+bool StateMergingSSE::isWorthMerging(const State& s1, const State& s2) {
+	return stateMerging && getZ3SSEMgr()->getMemDiffNum(s1.mem, s2.mem) <= maxMergeDiff;
+}
+
+/// The contents of the other partitions are merged with an ite, a partition never stored to on one path
+/// being the select of the initial memory array
+bool StateMergingSSE::canMerge(const State& s1, const State& s2) {
+	if (s1.concretized || s2.concretized)
+		return false;
+	for (const auto& it : s2.pointers) {
+		auto other = s1.pointers.find(it.first);
+		if (other != s1.pointers.end() && other->second.second != it.second.second)
+			return false;
+	}
+	Z3SSEMgr* z3Mgr = getZ3SSEMgr();
+	auto isAddress = [&](const Z3Mgr::MemPartitions& mem, u32_t addr, int64_t& val) {
+		auto it = mem.find(addr);
+		return it != mem.end() && z3Mgr->getConcreteValue(it->second, val) && z3Mgr->isVirtualMemAddress((u32_t) val);
+	};
+	for (const Z3Mgr::MemPartitions* mem : {&s1.mem, &s2.mem}) {
+		for (const auto& it : *mem) {
+			int64_t v1, v2;
+			bool p1 = isAddress(s1.mem, it.first, v1);
+			bool p2 = isAddress(s2.mem, it.first, v2);
+			if ((p1 || p2) && !(p1 && p2 && v1 == v2))
+				return false;
+		}
+	}
+	return true;
+}
+
+/// The bindings and definitions of a ValVar only bound on one path are kept, it is not used after the join
+/// (SSA form). Both states took the same back edges, so a ValVar defined on both paths has the same symbol
+void StateMergingSSE::merge(State& s1, const State& s2) {
+	Z3Mgr::MemPartitions mem;
+	getZ3SSEMgr()->mergeMemPartitions(s1.guard, s1.mem, s2.mem, mem);
+	s1.mem.swap(mem);
+	s1.guard = s1.guard || s2.guard;
+	s1.paths += s2.paths;
+	for (const auto& it : s2.pointers)
+		s1.pointers.insert(it);
+	for (const auto& it : s2.defs) {
+		u32_t& defs = s1.defs[it.first];
+		defs = std::max(defs, it.second);
+	}
+}
@@ -0,0 +1,139 @@
+//===- StateMergingSSE.h -- Static symbolic execution with state merging --//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Static symbolic execution with state merging at ICFG join points
+ *
+ * Instead of enumerating paths, symbolic states are propagated along the ICFG in reverse post-order,
+ * so the states of all paths reaching a join point are usually there before the join point is expanded.
+ * A state is a guard (its path condition), a memory and a calling context. Since ValVars are in SSA form,
+ * the constraints of a state can be shared by all states once guarded by the path condition: each
+ * constraint c added while translating an edge of state s is kept as (guard(s) => c). Two states at the
+ * same ICFGNode and call stack are merged into one with guard (g1 || g2) and with ite(g1, m1, m2) for
+ * every memory partition whose contents differ, so k independent branches give one state and a
+ * formula linear in k instead of 2^k paths.
+ * Pointers are resolved to a single object when translating, so states are only merged when the ValVars
+ * and memory partitions bound to addresses agree, and neither state had to concretize a value.
+ * Loops are unrolled up to the unroll bound of the budget: a state counts the back edges it took, and
+ * keeps the definitions of its path, so the ValVars redefined in a later iteration get their fresh symbols
+ * whenever the state is expanded.
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_STATEMERGINGSSE_H
+#define SOFTWARE_SECURITY_ANALYSIS_STATEMERGINGSSE_H
+
+#include "Assignment-4.h"
+#include <map>
+
+namespace SVF {
+
+	class StateMergingSSE : public SSE {
+	 public:
+		/// A symbolic state standing for all the paths merged into it
+		typedef Map<u32_t, std::pair<z3::expr, u32_t>> PointerBindings;	///< AST id -> (ValVar, address bound to it)
+
+		struct State {
+			const ICFGNode* node;		///< node reached (before translating its out edges)
+			CtxID callstack;		///< interned call stack of the traversal
+			CtxID callingCtx;		///< interned calling context of the translation
+			z3::expr guard;			///< path condition (disjunction over the merged paths)
+			Z3Mgr::MemPartitions mem;	///< memory after the path
+			Map<ICFGEdgeStackPair, u32_t> loops;	///< times each back edge was taken, up to the unroll bound
+			Z3SSEMgr::DefCounts defs;	///< definitions of the ValVars on the paths
+			u32_t paths;			///< number of paths merged into this state
+			PointerBindings pointers;	///< ValVars bound to an address on the paths
+			bool concretized;		///< a value was concretized with a model on the paths
+		};
+
+		/// Constructor
+		StateMergingSSE(SVFIR* s, ICFG* i, Z3Mgr::ValueDomain domain = (Z3Mgr::ValueDomain) Z3_BV_WIDTH);
+
+		/// Propagate the states from the program entry and check each assertion on the (merged) states reaching it
+		virtual void analyse() override;
+
+		/// Cost heuristic: merging two states saves translating and checking the rest of the program twice,
+		/// at the price of one ite per memory partition whose contents differ (and a larger guard).
+		/// States are merged if at most maxMergeDiff partitions differ, merging is disabled with setStateMerging(false)
+		virtual bool isWorthMerging(const State& s1, const State& s2);
+
+		inline void setStateMerging(bool merge) {
+			stateMerging = merge;
+		}
+		inline void setMaxMergeDiff(u32_t diff) {
+			maxMergeDiff = diff;
+		}
+
+		/// Constraints are added under the current guard as well as kept guarded for the other states
+		///@{
+		virtual void addToSolver(z3::expr e) override;
+		virtual void addBranchCondition(z3::expr cond) override;
+		///@}
+
+		/// Statistics of the last analyse
+		///@{
+		inline u32_t getStateNum() const {
+			return stateNum;
+		}
+		inline u32_t getMergeNum() const {
+			return mergeNum;
+		}
+		///@}
+
+	 private:
+		/// Number the ICFG nodes in reverse post-order from the program entry and find the back edges
+		void computeOrder();
+
+		/// Translate the edges out of s, each in its own solver scope under the guard of s
+		void expand(const State& s, const std::vector<const ICFGEdge*>& edges);
+
+		/// Expand s along its out edges, after checking the assertion at s->node (if any)
+		void step(const State& s);
+
+		/// Add a state to the worklist, merging it into a compatible state at the same node and call stack
+		void enqueue(State& s);
+
+		/// Soundness: s1 and s2 agree on every address bound to a ValVar or stored in memory, and neither was concretized
+		bool canMerge(const State& s1, const State& s2);
+
+		/// Merge s2 into s1, a ValVar keeps the symbol of its latest definition on either path
+		void merge(State& s1, const State& s2);
+
+		/// Keep the address e binds to a ValVar (if any), e.g., for an AddrStmt, a GepStmt or a CopyStmt
+		void recordPointer(const z3::expr& e);
+
+		Map<const ICFGNode*, u32_t> rpo;	///< reverse post-order number of each node
+		Set<const ICFGEdge*> backEdges;
+		std::map<std::pair<u32_t, CtxID>, std::vector<State>> worklist;	///< (rpo, call stack) -> states
+
+		z3::expr guard;		///< guard of the state being expanded
+		bool recording;		///< true while translating an edge
+		std::vector<z3::expr> guardedConstraints;	///< constraints translated for the current state, guarded
+		PointerBindings pointers;	///< pointer bindings of the path of the edge being translated
+
+		bool stateMerging;
+		u32_t maxMergeDiff;
+		u32_t stateNum;
+		u32_t mergeNum;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_STATEMERGINGSSE_H
@@ -1,18 +1,371 @@
 #include "Assignment-4.h"
+#include "ScheduledSSE.h"
+#include "StateMergingSSE.h"
 #include "SVF-LLVM/LLVMUtil.h"
 #include "Util/CommandLine.h"
 #include "Util/Options.h"
 #include "WPA/Andersen.h"
+#include <algorithm>
+#include <sstream>
 
 using namespace SVF;
 using namespace SVFUtil;
-u32_t SSE::assert_checked = 0;
+std::atomic<u32_t> SSE::assert_checked(0);
+
+/// Build the SVFIR (and its ICFG) of a module
+static SVFIR* buildSVFIR(const std::vector<std::string>& moduleNameVec) {
+    LLVMModuleSet::getLLVMModuleSet()->buildSVFModule(moduleNameVec);
+    LLVMModuleSet::getLLVMModuleSet()->dumpModulesToFile(".svf");
+
+    SVFIRBuilder builder;
+    SVFIR* svfir = builder.build();
+
+    CallGraph* callgraph = AndersenWaveDiff::createAndersenWaveDiff(svfir)->getCallGraph();
+    builder.updateCallGraph(callgraph);
+
+    /// ICFG
+    ICFG* icfg = svfir->getICFG();
+    icfg->updateCallGraph(callgraph);
+    return svfir;
+}
+
+static void releaseSVFIR() {
+    AndersenWaveDiff::releaseAndersenWaveDiff();
+    SVF::LLVMModuleSet::releaseLLVMModuleSet();
+    SVF::SVFIR::releaseSVFIR();
+    NodeIDAllocator::unset();
+}
+
+/// Return true if every assertion has a Verified verdict from at least one path
+static bool allVerified(SSE* sse) {
+    const VerdictTable::Verdicts& verdicts = sse->getVerdicts().getVerdicts();
+    if (verdicts.empty() || verdicts.size() != sse->identifySinks().size())
+        return false;
+    for (const auto& it : verdicts) {
+        if (it.second.kind != AssertionVerdict::Verified || it.second.paths == 0)
+            return false;
+    }
+    return true;
+}
+
+/// Push the first feasible out edge of node (the call edge of a call site first) and move to its destination,
+/// return the edge pushed, or nullptr if no out edge is feasible
+/// ScheduledSSE gives every assertion the same verdict (kind and number of paths) with each search strategy,
+/// and counts the states expanded before the first violation if and only if an assertion is violated
+static bool checkStrategies(SVFIR* svfir, ICFG* icfg, u32_t unrollBound = 1) {
+    std::vector<std::unique_ptr<SearchStrategy>> strategies;
+    strategies.emplace_back(new DFSStrategy());
+    strategies.emplace_back(new BFSStrategy());
+    strategies.emplace_back(new RandomPathStrategy());
+    strategies.emplace_back(new DistanceGuidedStrategy());
+    strategies.emplace_back(new CoverageGuidedStrategy());
+    VerdictTable::Verdicts expected;
+    for (std::unique_ptr<SearchStrategy>& strategy : strategies) {
+        ScheduledSSE sse(svfir, icfg);
+        sse.setBatchMode(true);
+        sse.getBudget().setLoopUnrollBound(unrollBound);
+        sse.setSearchStrategy(std::move(strategy));
+        sse.analyse();
+        const VerdictTable::Verdicts& verdicts = sse.getVerdicts().getVerdicts();
+        if (verdicts.empty() || verdicts.size() != sse.identifySinks().size())
+            return false;
+        bool violated = sse.getVerdicts().getNum(AssertionVerdict::Violated) > 0;
+        if (violated != (sse.getFirstViolationStateNum() != 0))
+            return false;
+        if (expected.empty())
+            expected = verdicts;
+        for (const auto& it : verdicts) {
+            auto other = expected.find(it.first);
+            if (other == expected.end() || other->second.kind != it.second.kind || other->second.paths != it.second.paths)
+                return false;
+        }
+    }
+    return true;
+}
+
+static const ICFGEdge* pushFirstEdge(SSE* sse, const ICFGNode*& node, SSE::CtxID& callstack, u32_t& depth) {
+    std::vector<const ICFGEdge*> edges(node->getOutEdges().begin(), node->getOutEdges().end());
+    std::stable_partition(edges.begin(), edges.end(), [](const ICFGEdge* e) {
+        return SVFUtil::isa<CallCFGEdge>(e);
+    });
+    for (const ICFGEdge* edge : edges) {
+        SSE::CtxID next;
+        if (sse->nextCallStack(callstack, edge, next) == false)
+            continue;
+        depth++;
+        if (sse->pushEdge(edge)) {
+            callstack = next;
+            node = edge->getDstNode();
+            return edge;
+        }
+        sse->popEdge();
+        depth--;
+    }
+    return nullptr;
+}
+
+/// Translate one path incrementally: from the program entry, push the first feasible out edge of each node
+/// until an assertion is reached and check it, then pop the whole path.
+/// Return false if the assertion fails or the solver and memory are not back to where they were
+static bool checkFirstPath(SSE* sse, ICFG* icfg) {
+    const u32_t maxDepth = 10000;
+    u32_t assertions = sse->getZ3SSEMgr()->getAssertions().size();
+    u32_t partitions = sse->getZ3SSEMgr()->getMemPartitions().size();
+
+    const ICFGNode* node = icfg->getGlobalICFGNode();
+    const IntraCFGEdge startEdge(nullptr, const_cast<ICFGNode*>(node));
+    SSE::CtxID callstack = CallingCtxTrie::EmptyCtx;
+    u32_t depth = 1;
+    bool feasible = sse->pushEdge(&startEdge);
+    bool verified = true;
+    while (feasible && depth < maxDepth) {
+        if (sse->isSink(node, nullptr)) {
+            verified = sse->assertchecking(node);
+            break;
+        }
+        feasible = pushFirstEdge(sse, node, callstack, depth) != nullptr;
+    }
+    for (; depth > 0; depth--)
+        sse->popEdge();
+    return verified && sse->getZ3SSEMgr()->getAssertions().size() == assertions
+           && sse->getZ3SSEMgr()->getMemPartitions().size() == partitions;
+}
+
+/// Follow the first path to the first call (e.g., of the leaf function getValue in test2) with and without
+/// function summaries: the return value substituted by the summary must be the one of the callee's body
+static bool checkSummary(SVFIR* svfir, ICFG* icfg) {
+    const u32_t maxDepth = 10000;
+    SSE plain(svfir, icfg);
+    SSE summarized(svfir, icfg);
+    summarized.setFunctionSummaries(true);
+
+    const ICFGNode* node = icfg->getGlobalICFGNode();
+    const IntraCFGEdge startEdge(nullptr, const_cast<ICFGNode*>(node));
+    SSE::CtxID callstack = CallingCtxTrie::EmptyCtx;
+    u32_t depth = 1;
+    bool feasible = plain.pushEdge(&startEdge) && summarized.pushEdge(&startEdge);
+    const CallCFGEdge* call = nullptr;
+    while (feasible && !call && depth < maxDepth) {
+        const ICFGNode* next = node;
+        SSE::CtxID nextCallstack = callstack;
+        u32_t nextDepth = depth;
+        const ICFGEdge* edge = pushFirstEdge(&plain, node, callstack, depth);
+        feasible = edge && pushFirstEdge(&summarized, next, nextCallstack, nextDepth) == edge;
+        call = feasible ? SVFUtil::dyn_cast<CallCFGEdge>(edge) : nullptr;
+    }
+    /// a callee that cannot be summarized (e.g., it calls another function) is not checked
+    const RetCFGEdge* ret = nullptr;
+    if (!call || !summarized.summarizeCall(call, ret))
+        return true;
+
+    /// the plain run returns to the call site along the first path through the callee's body
+    if (summarized.pushEdge(ret) == false)
+        return false;
+    const ICFGEdge* edge = call;
+    while (edge && edge != ret && depth < maxDepth)
+        edge = pushFirstEdge(&plain, node, callstack, depth);
+    if (edge != ret)
+        return false;
+    if (!ret->getRetPE())
+        return true;
+    NodeID lhs = ret->getRetPE()->getLHSVarID();
+    s32_t val = plain.getZ3SSEMgr()->z3Expr2NumValue(plain.getZ3Expr(lhs));
+    summarized.addToSolver(summarized.getZ3Expr(lhs) != summarized.getZ3Val(val));
+    return summarized.checkSolver() == Z3Mgr::Unsat;
+}
+
+/// Arrays: incremental translation of the first path, and the GEP caches of Z3SSEMgr
+int test1() {
+    SVFIR* svfir = buildSVFIR({"./Assignment-4/testcase/bc/test1.ll"});
+    ICFG* icfg = svfir->getICFG();
+    SSE* sse = new SSE(svfir, icfg);
+    sse->setBatchMode(true);
+    sse->analyse();
+    assert(allVerified(sse) && "test1 failed!");
+    assert(checkStrategies(svfir, icfg) && "test1 failed!");
+    assert(checkFirstPath(sse, icfg) && "test1 failed!");
+
+    /// the offset of a GepStmt with constant indices is the same in every calling context, and the field object of
+    /// a (base object, offset) is only added to the SVFIR by the first lookup
+    Z3SSEMgr* z3Mgr = sse->getZ3SSEMgr();
+    SSE::CtxID ctx = sse->getCallingCtxTrie().push(CallingCtxTrie::EmptyCtx, *sse->identifySinks().begin());
+    for (const SVFStmt* stmt : svfir->getSVFStmtSet(SVFStmt::Gep)) {
+        const GepStmt* gep = SVFUtil::cast<GepStmt>(stmt);
+        assert((!gep->isConstantOffset() || z3Mgr->getGepOffset(gep, ctx) == z3Mgr->getGepOffset(gep, CallingCtxTrie::EmptyCtx))
+               && "test1 failed!");
+    }
+    NodeID array = 0;
+    for (const SVFStmt* stmt : svfir->getSVFStmtSet(SVFStmt::Addr)) {
+        NodeID obj = SVFUtil::cast<AddrStmt>(stmt)->getRHSVarID();
+        const BaseObjVar* base = svfir->getBaseObject(obj);
+        if (!SVFUtil::isa<FunObjVar>(base) && !base->isConstDataOrAggData() && !base->isConstantArray() && !base->isConstantStruct())
+            array = obj;
+    }
+    z3::expr field = z3Mgr->getGepObjAddress(z3Mgr->getMemObjAddress(array), 0);
+    u32_t vars = svfir->getSVFVarNum();
+    assert(z3::eq(field, z3Mgr->getGepObjAddress(z3Mgr->getMemObjAddress(array), 0)) && svfir->getSVFVarNum() == vars
+           && "test1 failed!");
+    std::cout << SVFUtil::sucMsg("test1 passed!") << std::endl;
+    delete sse;
+    releaseSVFIR();
+    return 0;
+}
+
+/// Calls: the expr cache of Z3SSEMgr across calling contexts, and the summary of the leaf function getValue
+int test2() {
+    SVFIR* svfir = buildSVFIR({"./Assignment-4/testcase/bc/test2.ll"});
+    ICFG* icfg = svfir->getICFG();
+    SSE* sse = new SSE(svfir, icfg);
+    sse->setBatchMode(true);
+    sse->analyse();
+    assert(allVerified(sse) && "test2 failed!");
+    assert(checkStrategies(svfir, icfg) && "test2 failed!");
+
+    /// the expr of a ValVar is cached per calling context, the expr of a constant is shared by all contexts
+    const CallICFGNode* assertion = SVFUtil::cast<CallICFGNode>(*sse->identifySinks().begin());
+    Z3SSEMgr* z3Mgr = sse->getZ3SSEMgr();
+    SSE::CtxID ctx = sse->getCallingCtxTrie().push(CallingCtxTrie::EmptyCtx, assertion);
+    NodeID arg = assertion->getActualParms().at(0)->getId();
+    z3::expr inCtx = z3Mgr->getZ3Expr(arg, ctx);
+    assert(z3::eq(inCtx, z3Mgr->getZ3Expr(arg, ctx)) && !z3::eq(inCtx, z3Mgr->getZ3Expr(arg, CallingCtxTrie::EmptyCtx))
+           && "test2 failed!");
+    assert(checkSummary(svfir, icfg) && "test2 failed!");
+    std::cout << SVFUtil::sucMsg("test2 passed!") << std::endl;
+    delete sse;
+    releaseSVFIR();
+    return 0;
+}
+
+/// Verdicts of the assertion folded from two tables: the violation and its smallest counterexample win,
+/// and the JSON report escapes the counterexample text
+int test3() {
+    SVFIR* svfir = buildSVFIR({"./Assignment-4/testcase/bc/test3.ll"});
+    ICFG* icfg = svfir->getICFG();
+    SSE* sse = new SSE(svfir, icfg);
+    sse->setBatchMode(true);
+    sse->analyse();
+    assert(allVerified(sse) && "test3 failed!");
+    assert(checkStrategies(svfir, icfg) && "test3 failed!");
+
+    const ICFGNode* sink = *sse->identifySinks().begin();
+    VerdictTable verified(sse->getVerdicts());
+    VerdictTable violated;
+    violated.record(sink, Z3Mgr::Sat, "y = 2");
+    violated.record(sink, Z3Mgr::Sat, "x = \"1\"\n");
+    u32_t paths = verified.getVerdicts().at(sink->getId()).paths + 2;
+    verified.merge(violated);
+    verified.finish({sink});
+    const AssertionVerdict& verdict = verified.getVerdicts().at(sink->getId());
+    assert(verdict.kind == AssertionVerdict::Violated && verdict.paths == paths && verdict.counterexample == "x = \"1\"\n"
+           && "test3 failed!");
+
+    VerdictTable partial;
+    partial.record(sink, Z3Mgr::Unsat, "");
+    partial.markPartial(sink);
+    partial.finish({sink});
+    assert(partial.getNum(AssertionVerdict::BudgetExceeded) == 1 && "test3 failed!");
+
+    std::stringstream report;
+    verified.writeReport(report);
+    std::stringstream expected;
+    expected << "\"verdict\": \"violated\", \"paths\": " << paths << ", \"counterexample\": \"x = \\\"1\\\"\\n\"}";
+    assert(report.str().find(expected.str()) != std::string::npos && "test3 failed!");
+    assert(report.str().find("\"summary\": {\"verified\": 0, \"violated\": 1, \"unknown\": 0, \"budget-exceeded\": 0}")
+           != std::string::npos && "test3 failed!");
+    std::cout << SVFUtil::sucMsg("test3 passed!") << std::endl;
+    delete sse;
+    releaseSVFIR();
+    return 0;
+}
+
+/// Loops: the assertion is only reached after two iterations, by the path and the state merging engines
+int test4() {
+    SVFIR* svfir = buildSVFIR({"./Assignment-4/testcase/bc/test4.ll"});
+    ICFG* icfg = svfir->getICFG();
+    SSE* sse = new SSE(svfir, icfg);
+    sse->setBatchMode(true);
+    sse->getBudget().setLoopUnrollBound(2);
+    sse->analyse();
+    assert(allVerified(sse) && "test4 failed!");
+    assert(checkStrategies(svfir, icfg, 2) && "test4 failed!");
+
+    StateMergingSSE* merging = new StateMergingSSE(svfir, icfg);
+    merging->setBatchMode(true);
+    merging->getBudget().setLoopUnrollBound(2);
+    merging->analyse();
+    assert(allVerified(merging) && "test4 failed!");
+    delete merging;
+    std::cout << SVFUtil::sucMsg("test4 passed!") << std::endl;
+    delete sse;
+    releaseSVFIR();
+    return 0;
+}
+
+/// Two assertions: a multi-sink run checks both in one traversal, each from the paths reaching it
+int test5() {
+    SVFIR* svfir = buildSVFIR({"./Assignment-4/testcase/bc/test5.ll"});
+    ICFG* icfg = svfir->getICFG();
+    SSE* sse = new SSE(svfir, icfg);
+    sse->setMultiSink(true);
+    sse->setBatchMode(true);
+    sse->analyse();
+    assert(allVerified(sse) && sse->identifySinks().size() == 2 && "test5 failed!");
+    assert(checkStrategies(svfir, icfg) && "test5 failed!");
+
+    /// merged states must not resolve a pointer to the object of one path only, e.g., p
+    StateMergingSSE* merging = new StateMergingSSE(svfir, icfg);
+    merging->setBatchMode(true);
+    merging->analyse();
+    assert(allVerified(merging) && "test5 failed!");
+    delete merging;
+    std::cout << SVFUtil::sucMsg("test5 passed!") << std::endl;
+    delete sse;
+    releaseSVFIR();
+    return 0;
+}
+
+/// An assertion inside a callee: the callee is not summarized, so the assertion is checked in both calls
+int test6() {
+    SVFIR* svfir = buildSVFIR({"./Assignment-4/testcase/bc/test6.ll"});
+    ICFG* icfg = svfir->getICFG();
+    SSE* sse = new SSE(svfir, icfg);
+    sse->setFunctionSummaries(true);
+    sse->setBatchMode(true);
+    sse->analyse();
+    assert(allVerified(sse) && sse->getFunctionSummaryMgr()->getSummaryNum() == 0 && "test6 failed!");
+    assert(checkStrategies(svfir, icfg) && "test6 failed!");
+    std::cout << SVFUtil::sucMsg("test6 passed!") << std::endl;
+    delete sse;
+    releaseSVFIR();
+    return 0;
+}
+
+/// A violated assertion: every search strategy finds the counterexample after expanding some states
+int test7() {
+    SVFIR* svfir = buildSVFIR({"./Assignment-4/testcase/bc/test7.ll"});
+    ICFG* icfg = svfir->getICFG();
+    SSE* sse = new SSE(svfir, icfg);
+    sse->setBatchMode(true);
+    sse->analyse();
+    assert(sse->getVerdicts().getNum(AssertionVerdict::Violated) == 1 && "test7 failed!");
+    assert(checkStrategies(svfir, icfg) && "test7 failed!");
+
+    ScheduledSSE* scheduled = new ScheduledSSE(svfir, icfg);
+    scheduled->setBatchMode(true);
+    scheduled->analyse();
+    assert(scheduled->getFirstViolationStateNum() != 0 && "test7 failed!");
+    delete scheduled;
+    std::cout << SVFUtil::sucMsg("test7 passed!") << std::endl;
+    delete sse;
+    releaseSVFIR();
+    return 0;
+}
 
 /*
  // Software-Verification-Teaching Assignment 4 main function entry
- // To run your program with testcases , please set the bitcode from Assignment-2/Tests/testcases/sse/ for "args" in
- file'.vscode/launch.json'
- // e.g. To check test1, set "args": ["Assignment-2/Tests/testcases/sse/test1.ll"] in file'.vscode/launch.json'
+ // Without input bitcode, the testcases of Assignment-4/testcase/bc are checked.
+ // To run your program with a testcase, please set the bitcode for "args" in file'.vscode/launch.json'
+ // e.g. To check test1, set "args": ["Assignment-4/testcase/bc/test1.ll"] in file'.vscode/launch.json'
  */
 int main(int argc, char** argv) {
     int arg_num = 0;
@@ -34,28 +387,27 @@ int main(int argc, char** argv) {
                                              arg_value,
                                              "Software-Verification-Teaching Assignment 4",
                                              "[options] <input-bitcode...>");
+    delete[] arg_value;
 
-    LLVMModuleSet::getLLVMModuleSet()->buildSVFModule(moduleNameVec);
-    LLVMModuleSet::getLLVMModuleSet()->dumpModulesToFile(".svf");
-
-    SVFIRBuilder builder;
-    SVFIR* svfir = builder.build();
-
-    CallGraph* CallGraph = AndersenWaveDiff::createAndersenWaveDiff(svfir)->getCallGraph();
-    builder.updateCallGraph(CallGraph);
-
-    /// ICFG
-    ICFG* icfg = svfir->getICFG();
-    icfg->updateCallGraph(CallGraph);
+    if (moduleNameVec.empty()) {
+        test1();
+        test2();
+        test3();
+        test4();
+        test5();
+        test6();
+        test7();
+        return 0;
+    }
 
-    SSE* sse = new SSE(svfir, icfg);
+    SVFIR* svfir = buildSVFIR(moduleNameVec);
+    SSE* sse = new SSE(svfir, svfir->getICFG());
+    /// test4 only reaches its assertion after two iterations of a loop
+    sse->getBudget().setLoopUnrollBound(2);
     sse->analyse();
-
-    SVF::LLVMModuleSet::releaseLLVMModuleSet();
-    SVF::SVFIR::releaseSVFIR();
-
-    delete[] arg_value;
     delete sse;
+    releaseSVFIR();
+
     if (SSE::assert_checked > 0) {
         return 0;
     }
@@ -63,4 +415,4 @@ int main(int argc, char** argv) {
         std::cerr << "No assertion was checked!" << std::endl;
         return 1;
     }
-}
\ No newline at end of file
+}
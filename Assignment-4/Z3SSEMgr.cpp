@@ -36,9 +36,12 @@ using namespace SVFUtil;
 using namespace llvm;
 using namespace z3;
 
-Z3SSEMgr::Z3SSEMgr(SVFIR* ir)
-: Z3Mgr(ir->getSVFVarNum() * 10)
-, svfir(ir) {
+std::shared_mutex Z3SSEMgr::svfirMutex;
+
+Z3SSEMgr::Z3SSEMgr(SVFIR* ir, ValueDomain domain)
+: Z3Mgr(ir->getSVFVarNum() * 10, domain)
+, svfir(ir)
+, redefinitions(0) {
 }
 
 
@@ -51,17 +54,19 @@ z3::expr Z3SSEMgr::createExprForObjVar(const ObjVar* objVar) {
 	std::string str;
 	raw_string_ostream rawstr(str);
 	expr e(ctx);
+	/// the base object is queried under the lock, getGepObjAddress of another worker may add to the SVFIR
+	std::shared_lock<std::shared_mutex> lock(svfirMutex);
 	const BaseObjVar* obj = PAG::getPAG()->getBaseObject(objVar->getId());
 	/// constant data
 	if (obj->isConstDataOrAggData() || obj->isConstantArray() || obj->isConstantStruct()) {
 		if (const ConstIntObjVar* consInt = SVFUtil::dyn_cast<ConstIntObjVar>(objVar)) {
-			e = ctx.int_val((s32_t)consInt->getSExtValue());
+			e = getZ3Val((s32_t)consInt->getSExtValue());
 		}
 		else if (const ConstFPObjVar* consFp = SVFUtil::dyn_cast<ConstFPObjVar>(objVar)) {
-			e = ctx.int_val(static_cast<u32_t>(consFp->getFPValue()));
+			e = getZ3Val(static_cast<u32_t>(consFp->getFPValue()));
 		}
 		else if (SVFUtil::isa<GlobalObjVar>(objVar)) {
-			e = ctx.int_val(getVirtualMemAddress(objVar->getId()));
+			e = getZ3Val(getVirtualMemAddress(objVar->getId()));
 		}
 		else if (obj->isConstantArray() || obj->isConstantStruct()) {
 			assert(false && "implement this part");
@@ -73,7 +78,7 @@ z3::expr Z3SSEMgr::createExprForObjVar(const ObjVar* objVar) {
 	}
 	/// locations (address-taken variables)
 	else {
-		e = ctx.int_val(getVirtualMemAddress(objVar->getId()));
+		e = getZ3Val(getVirtualMemAddress(objVar->getId()));
 	}
 	return e;
 }
@@ -89,51 +94,153 @@ std::string Z3SSEMgr::callingCtxToStr(const CallStack& callingCtx) {
     return rawstr.str();
 }
 
-z3::expr Z3SSEMgr::getZ3Expr(SVF::u32_t idx, const CallStack& callingCtx) {
+std::string Z3SSEMgr::callingCtxToStr(CtxID callingCtx) {
+    return callingCtxToStr(ctxTrie.getCallStack(callingCtx));
+}
+
+z3::expr Z3SSEMgr::getObjVarExpr(const ObjVar* obj) {
+	auto it = objVarExprCache.find(obj->getId());
+	if (it == objVarExprCache.end())
+		it = objVarExprCache.emplace(obj->getId(), createExprForObjVar(obj)).first;
+	return it->second;
+}
+
+/// Exprs are cached, so the symbol name (and the string formatting of callingCtx) is only built on the first lookup
+z3::expr Z3SSEMgr::getZ3Expr(SVF::u32_t idx, CtxID callingCtx) {
     u32_t varId = getInternalID(idx);
     assert(varId == idx && "SVFVar idx overflow > 0x7f000000?");
-    std::string str;
-    std::stringstream rawstr(str);
-    const SVFVar *svfVar = svfir->getGNode(varId);
+    const SVFVar *svfVar = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> lock(svfirMutex);
+        svfVar = svfir->getGNode(varId);
+    }
     if (const ObjVar* objVar = SVFUtil::dyn_cast<ObjVar>(svfVar)) {
-        return createExprForObjVar(objVar);
+        return getObjVarExpr(objVar);
+    }
+    // Check if svfVar does not have a value or it has a constant value
+    else if (SVFUtil::isa<ConstDataValVar, ConstDataObjVar>(svfVar)) {
+        // If there's no value or it's a constant, we do not add the callingCtx to z3 expr
+        auto it = constVarExprCache.find(varId);
+        if (it == constVarExprCache.end()) {
+            std::stringstream rawstr;
+            rawstr << "ValVar" << varId;
+            it = constVarExprCache.emplace(varId, getZ3Const(rawstr.str().c_str())).first;
+        }
+        return it->second;
     } else {
-
-        // Check if svfVar does not have a value or it has a constant value
-		if (!SVFUtil::isa<ConstDataValVar, ConstDataObjVar>(svfVar)) {
-            // If there is a non-constant value, add callingCtx to z3 expr
-            rawstr << callingCtxToStr(callingCtx);
-        } else {
-            // If there's no value or it's a constant, we do not add the callingCtx to z3 expr
+        // If there is a non-constant value, add callingCtx to z3 expr
+        u64_t key = ((u64_t) callingCtx << 32) | varId;
+        auto it = valVarExprCache.find(key);
+        if (it == valVarExprCache.end()) {
+            std::stringstream rawstr;
+            rawstr << callingCtxToStr(callingCtx) << "ValVar" << varId;
+            it = valVarExprCache.emplace(key, getZ3Const(rawstr.str().c_str())).first;
         }
-        rawstr << "ValVar" << varId;
-        std::string name = rawstr.str();
-        return ctx.int_const(name.c_str());
+        return it->second;
     }
 }
 
+z3::expr Z3SSEMgr::getZ3Expr(SVF::u32_t idx, const CallStack& callingCtx) {
+    return getZ3Expr(idx, getCallingCtxID(callingCtx));
+}
+
+/// The first definition keeps the symbol of the ValVar and the k-th one (k > 1) uses "<symbol>#<k-1>".
+/// ObjVars and constants are not defined by statements, getZ3Expr does not put them in valVarExprCache
+void Z3SSEMgr::newDefinition(u32_t idx, CtxID callingCtx) {
+	z3::expr cur = getZ3Expr(idx, callingCtx);
+	u64_t key = ((u64_t) callingCtx << 32) | idx;
+	auto it = valVarExprCache.find(key);
+	if (it == valVarExprCache.end())
+		return;
+	defTrail.emplace_back(key, cur);
+	u32_t& defs = defCounts[key];
+	if (defs++ > 0) {
+		std::stringstream rawstr;
+		rawstr << callingCtxToStr(callingCtx) << "ValVar" << idx << "#" << defs - 1;
+		it->second = getZ3Const(rawstr.str().c_str());
+		redefinitions++;
+	}
+}
+
+void Z3SSEMgr::undoDefinitions(u32_t mark) {
+	while (defTrail.size() > mark) {
+		const std::pair<u64_t, z3::expr>& def = defTrail.back();
+		valVarExprCache.find(def.first)->second = def.second;
+		auto it = defCounts.find(def.first);
+		if (--it->second == 0)
+			defCounts.erase(it);
+		else
+			redefinitions--;
+		defTrail.pop_back();
+	}
+}
+
+/// Symbols are named after the number of definitions, so the same counts give the same symbols
+void Z3SSEMgr::setDefinitions(const DefCounts& defs) {
+	assert(&defs != &defCounts && "definitions of another path expected");
+	undoDefinitions(0);
+	for (const auto& it : defs) {
+		for (u32_t i = 0; i < it.second; i++)
+			newDefinition((u32_t) (it.first & 0xffffffff), (CtxID) (it.first >> 32));
+	}
+}
+
+void Z3SSEMgr::getValVarExprs(CtxID callingCtx, std::vector<std::pair<NodeID, z3::expr>>& vars) const {
+	for (const auto& it : valVarExprCache) {
+		if ((CtxID) (it.first >> 32) == callingCtx)
+			vars.push_back(std::make_pair((NodeID) (it.first & 0xffffffff), it.second));
+	}
+}
+
 /// Return the address expr of a ObjVar
 z3::expr Z3SSEMgr::getMemObjAddress(u32_t idx) {
 	NodeID objIdx = getInternalID(idx);
-	assert(SVFUtil::isa<ObjVar>(svfir->getGNode(objIdx)) && "Fail to get the MemObj!");
-   	return createExprForObjVar(SVFUtil::cast<ObjVar>(svfir->getGNode(objIdx)));
+	const SVFVar* objVar = nullptr;
+	{
+		std::shared_lock<std::shared_mutex> lock(svfirMutex);
+		objVar = svfir->getGNode(objIdx);
+	}
+	assert(SVFUtil::isa<ObjVar>(objVar) && "Fail to get the MemObj!");
+   	return getObjVarExpr(SVFUtil::cast<ObjVar>(objVar));
 }
 
+/// The field object of each (base object, offset) is only looked up and created once
 z3::expr Z3SSEMgr::getGepObjAddress(z3::expr pointer, u32_t offset) {
 	NodeID obj = getInternalID(z3Expr2NumValue(pointer));
-	assert(SVFUtil::isa<ObjVar>(svfir->getGNode(obj)) && "Fail to get the base object address!");
-	NodeID gepObj = svfir->getGepObjVar(obj, offset);
-	/// TODO: check whether this node has been created before or not to save creation time
-	if (obj == gepObj)
-		return createExprForObjVar(SVFUtil::cast<ObjVar>(svfir->getGNode(obj)));
-	else
-		return createExprForObjVar(SVFUtil::cast<GepObjVar>(svfir->getGNode(gepObj)));
+	u64_t key = ((u64_t) obj << 32) | offset;
+	auto it = gepObjExprCache.find(key);
+	if (it != gepObjExprCache.end())
+		return it->second;
+
+	const SVFVar* gepObjVar = nullptr;
+	{
+		/// getGepObjVar may add a new field object to the SVFIR
+		std::unique_lock<std::shared_mutex> lock(svfirMutex);
+		assert(SVFUtil::isa<ObjVar>(svfir->getGNode(obj)) && "Fail to get the base object address!");
+		gepObjVar = svfir->getGNode(svfir->getGepObjVar(obj, offset));
+	}
+	z3::expr e = getObjVarExpr(SVFUtil::cast<ObjVar>(gepObjVar));
+	gepObjExprCache.emplace(key, e);
+	return e;
 }
 
 s32_t Z3SSEMgr::getGepOffset(const GepStmt* gep, const CallStack& callingCtx) {
-	if (gep->getOffsetVarAndGepTypePairVec().empty())
-		return gep->getConstantStructFldIdx();
+	return getGepOffset(gep, getCallingCtxID(callingCtx));
+}
 
+/// The offset of a GepStmt whose indices are all constants is computed once and cached
+s32_t Z3SSEMgr::getGepOffset(const GepStmt* gep, CtxID callingCtx) {
+	auto it = constGepOffsetCache.find(gep);
+	if (it != constGepOffsetCache.end())
+		return it->second;
+
+	if (gep->getOffsetVarAndGepTypePairVec().empty()) {
+		s32_t fldIdx = gep->getConstantStructFldIdx();
+		constGepOffsetCache[gep] = fldIdx;
+		return fldIdx;
+	}
+
+	bool constantOffset = true;
 	s32_t totalOffset = 0;
 	for (int i = gep->getOffsetVarAndGepTypePairVec().size() - 1; i >= 0; i--) {
 		const SVFVar* var = gep->getOffsetVarAndGepTypePairVec()[i].first;
@@ -143,6 +250,7 @@ s32_t Z3SSEMgr::getGepOffset(const GepStmt* gep, const CallStack& callingCtx) {
 			offset = constInt->getSExtValue();
 		} else {
 			offset = z3Expr2NumValue(getZ3Expr(var->getId(), callingCtx));
+			constantOffset = false;
 		}
 
 		if (type == nullptr) {
@@ -151,28 +259,56 @@ s32_t Z3SSEMgr::getGepOffset(const GepStmt* gep, const CallStack& callingCtx) {
 		}
 
 		/// Caculate the offset
+		std::shared_lock<std::shared_mutex> lock(svfirMutex);
 		if (const SVFPointerType* pty = SVFUtil::dyn_cast<SVFPointerType>(type))
 			totalOffset += offset * gep->getAccessPath().getElementNum(gep->getAccessPath().gepSrcPointeeType());
 		else
 			totalOffset += PAG::getPAG()->getFlattenedElemIdx(type, offset);
 	}
+	if (constantOffset)
+		constGepOffsetCache[gep] = totalOffset;
 	return totalOffset;
 }
 
-void Z3SSEMgr::printExprValues(const CallStack& callingCtx) {
+void Z3SSEMgr::printExprValues(CtxID callingCtx) {
 	std::cout.flags(std::ios::left);
 	std::cout << "\n-----------SVFVar and Value-----------\n";
 	std::map<std::string, std::string> printValMap;
 	std::map<NodeID, std::string> objKeyMap;
 	std::map<NodeID, std::string> valKeyMap;
-	for (SVFIR::iterator nIter = svfir->begin(); nIter != svfir->end(); ++nIter) {
-		expr e = getEvalExpr(getZ3Expr(nIter->first, callingCtx));
-		if (e.is_numeral()) {
-			NodeID varID = nIter->second->getId();
-			s32_t value = e.get_numeral_int64();
+
+	/// Evaluate all SVFVars under one model
+	std::vector<const SVFVar*> vars;
+	expr_vector exprs(ctx);
+	{
+		std::shared_lock<std::shared_mutex> lock(svfirMutex);
+		for (SVFIR::iterator nIter = svfir->begin(); nIter != svfir->end(); ++nIter)
+			vars.push_back(nIter->second);
+	}
+	for (const SVFVar* var : vars)
+		exprs.push_back(getZ3Expr(var->getId(), callingCtx));
+	Z3EvalTable values;
+	evalAll(exprs, values);
+
+	/// Evaluate the contents of all ObjVars holding an address under the same model
+	std::vector<u32_t> contentIdx(vars.size(), 0);
+	expr_vector contents(ctx);
+	for (u32_t i = 0; i < vars.size(); i++) {
+		if (values[i].isNumeral && SVFUtil::isa<ObjVar>(vars[i]) && isVirtualMemAddress(values[i].value)) {
+			contentIdx[i] = contents.size();
+			contents.push_back(loadValue(getZ3Val(values[i].value)));
+		}
+	}
+	Z3EvalTable storedValues;
+	evalAll(contents, storedValues);
+
+	for (u32_t i = 0; i < vars.size(); i++) {
+		if (values[i].isNumeral) {
+			NodeID varID = vars[i]->getId();
+			s32_t value = values[i].value;
 			std::stringstream exprName;
 			std::stringstream valstr;
-			if (const ValVar* valVar = SVFUtil::dyn_cast<ValVar>(nIter->second)) {
+			if (SVFUtil::isa<ValVar>(vars[i])) {
 				exprName << "ValVar" << varID;
 				if (isVirtualMemAddress(value))
 					valstr << "\t Value: " << std::hex << "0x" << value << "\n";
@@ -184,9 +320,9 @@ void Z3SSEMgr::printExprValues(const CallStack& callingCtx) {
 			else {
 				exprName << "ObjVar" << varID << std::hex << " (0x" << getVirtualMemAddress(varID) << ") ";
 				if (isVirtualMemAddress(value)) {
-					expr storedValue = getEvalExpr(loadValue(e));
-					if (storedValue.is_numeral()) {
-						s32_t contentValue = z3Expr2NumValue(storedValue);
+					const Z3EvalValue& stored = storedValues[contentIdx[i]];
+					if (stored.isNumeral) {
+						s32_t contentValue = stored.value;
 						if (isVirtualMemAddress(contentValue))
 							valstr << "\t Value: " << std::hex << "0x" << contentValue << "\n";
 						else
@@ -213,4 +349,4 @@ void Z3SSEMgr::printExprValues(const CallStack& callingCtx) {
 		std::cout << std::setw(25) << printKey << printValMap[printKey];
 	}
 	std::cout << "-----------------------------------------\n";
-}
+}
\ No newline at end of file
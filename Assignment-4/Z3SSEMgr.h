@@ -29,7 +29,10 @@
 #define SOFTWARE_SECURITY_ANALYSIS_Z3SSEMGR_H
 
 #include "Z3Mgr.h"
+#include "CallingCtxTrie.h"
 #include "SVFIR/SVFIR.h"
+#include <mutex>
+#include <shared_mutex>
 
 namespace SVF {
 
@@ -41,17 +44,60 @@ namespace SVF {
 	class Z3SSEMgr : public Z3Mgr {
         	typedef std::vector<const ICFGNode*> CallStack;
 	 public:
+		typedef CallingCtxTrie::CtxID CtxID;
+
 		/// Constructor
-		Z3SSEMgr(SVFIR* ir);
+		Z3SSEMgr(SVFIR* ir, ValueDomain domain = (ValueDomain) Z3_BV_WIDTH);
 
 
+        	std::string callingCtxToStr(CtxID callingCtx);
         	std::string callingCtxToStr(const CallStack& callingCtx);
 
+		/// Return the expr of a SVFVar under an interned calling context
+        	z3::expr getZ3Expr(u32_t idx, CtxID callingCtx);
         	z3::expr getZ3Expr(u32_t idx, const CallStack& callingCtx);
 
+		/// Return the interned ID of a calling context
+		inline CtxID getCallingCtxID(const CallStack& callingCtx) {
+			return ctxTrie.getCtxID(callingCtx);
+		}
+
+		/// Loop unrolling: each definition of a ValVar on the path after its first one (i.e., in a later
+		/// iteration of its loop) gets a fresh symbol, which getZ3Expr returns until the definition is undone
+		///@{
+		typedef Map<u64_t, u32_t> DefCounts;	///< (ctxId << 32 | varId) -> definitions on the path
+		void newDefinition(u32_t idx, CtxID callingCtx);
+		/// Number of definitions recorded, undoDefinitions(mark) undoes the ones recorded after mark
+		inline u32_t getDefinitionMark() const {
+			return defTrail.size();
+		}
+		void undoDefinitions(u32_t mark);
+		/// The definitions of another path (e.g., of a symbolic state), setDefinitions undoes all the
+		/// definitions and records defs instead, so getZ3Expr returns the symbols of that path
+		inline const DefCounts& getDefinitions() const {
+			return defCounts;
+		}
+		void setDefinitions(const DefCounts& defs);
+		/// Number of recorded definitions that are not the first one of their ValVar
+		inline u32_t getRedefinitionNum() const {
+			return redefinitions;
+		}
+		///@}
+
+		/// Collect the exprs of the (non-constant) ValVars created so far under callingCtx
+		void getValVarExprs(CtxID callingCtx, std::vector<std::pair<NodeID, z3::expr>>& vars) const;
+
+		/// Trie interning the calling contexts of this manager
+		inline CallingCtxTrie& getCallingCtxTrie() {
+			return ctxTrie;
+		}
+
 		/// Initialize the expr value for each objects (address-taken variables and constants)
 		z3::expr createExprForObjVar(const ObjVar* obj);
 
+		/// Return the (memoized) expr of a ObjVar created by createExprForObjVar
+		z3::expr getObjVarExpr(const ObjVar* obj);
+
 		/// Return the address expr of a ObjVar
 		z3::expr getMemObjAddress(u32_t idx);
 
@@ -59,13 +105,32 @@ namespace SVF {
 		z3::expr getGepObjAddress(z3::expr pointer, u32_t offset);
 
 		/// Return the offset expression of a GepStmt
+		s32_t getGepOffset(const GepStmt* gep, CtxID callingCtx);
 		s32_t getGepOffset(const GepStmt* gep, const CallStack& callingCtx);
 
 		/// Dump values of all exprs
-		virtual void printExprValues(const CallStack& callingCtx);
+		virtual void printExprValues(CtxID callingCtx);
+		inline void printExprValues(const CallStack& callingCtx) {
+			printExprValues(getCallingCtxID(callingCtx));
+		}
 
 	 private:
 		SVFIR* svfir;
+		/// Cached exprs, created once per context-sensitive ValVar, constant ValVar and ObjVar
+		///@{
+		Map<u64_t, z3::expr> valVarExprCache;	///< (ctxId << 32 | varId) -> expr
+		Map<NodeID, z3::expr> constVarExprCache;
+		Map<NodeID, z3::expr> objVarExprCache;
+		Map<u64_t, z3::expr> gepObjExprCache;	///< (baseObj << 32 | offset) -> field object expr
+		///@}
+		Map<const GepStmt*, s32_t> constGepOffsetCache;	///< offsets of GepStmts with constant indices
+		DefCounts defCounts;
+		std::vector<std::pair<u64_t, z3::expr>> defTrail;	///< (key, expr before the definition) of each definition
+		u32_t redefinitions;
+		CallingCtxTrie ctxTrie;
+		/// Guards the SVFIR shared by the managers of parallel workers: every query of the SVFIR (node, base
+		/// object and type lookups) takes it shared, creating a field object (SVFIR::getGepObjVar) takes it exclusively
+		static std::shared_mutex svfirMutex;
 	};
 
 } // namespace SVF
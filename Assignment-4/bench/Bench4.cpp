@@ -0,0 +1,119 @@
+//===- Bench4.cpp -- Int vs. bit-vector encoding benchmark for SSE ----------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Compare the Int encoding against the pure bit-vector (QF_ABV) encodings of Z3Mgr
+ * by running SSE on each program, e.g., bench-4 Assignment-4/testcase/bc/test1.ll
+ * (defaults to the Assignment-4 testcases if no program is given).
+ * SSE has to be completed first (the TODOs of Assignment-4.cpp), otherwise no path is translated and the
+ * times are meaningless. SSE runs in batch mode, so a violated assertion is reported instead of aborting the run.
+ */
+
+#include "Assignment-4.h"
+#include "SVF-LLVM/LLVMUtil.h"
+#include "Util/CommandLine.h"
+#include "Util/Options.h"
+#include "WPA/Andersen.h"
+#include <chrono>
+#include <iomanip>
+
+using namespace SVF;
+using namespace SVFUtil;
+std::atomic<u32_t> SSE::assert_checked(0);
+
+static const char* domainName(Z3Mgr::ValueDomain domain) {
+    switch (domain) {
+    case Z3Mgr::IntDomain:
+        return "Int";
+    case Z3Mgr::BV32Domain:
+        return "BV32";
+    case Z3Mgr::BV64Domain:
+        return "BV64";
+    }
+    return "?";
+}
+
+/// Run SSE on one module with each value domain and print the analysis time
+static void benchModule(const std::string& module) {
+    std::vector<std::string> moduleNameVec = {module};
+    LLVMModuleSet::getLLVMModuleSet()->buildSVFModule(moduleNameVec);
+
+    SVFIRBuilder builder;
+    SVFIR* svfir = builder.build();
+
+    CallGraph* callgraph = AndersenWaveDiff::createAndersenWaveDiff(svfir)->getCallGraph();
+    builder.updateCallGraph(callgraph);
+
+    /// ICFG
+    ICFG* icfg = svfir->getICFG();
+    icfg->updateCallGraph(callgraph);
+
+    for (Z3Mgr::ValueDomain domain : {Z3Mgr::IntDomain, Z3Mgr::BV32Domain, Z3Mgr::BV64Domain}) {
+        SSE::assert_checked = 0;
+        SSE* sse = new SSE(svfir, icfg, domain);
+        sse->setBatchMode(true);
+        auto start = std::chrono::steady_clock::now();
+        sse->analyse();
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << std::left << std::setw(40) << module << std::setw(8) << domainName(domain)
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(3) << ms << " ms"
+                  << std::setw(8) << SSE::assert_checked << " asserts"
+                  << std::setw(8) << sse->getUnknownQueryNum() << " unknown\n";
+        delete sse;
+    }
+
+    SVF::LLVMModuleSet::releaseLLVMModuleSet();
+    SVF::SVFIR::releaseSVFIR();
+    NodeIDAllocator::unset();
+}
+
+int main(int argc, char** argv) {
+    int arg_num = 0;
+    int extraArgc = 4;
+    char** arg_value = new char*[argc + extraArgc];
+    for (; arg_num < argc; ++arg_num) {
+        arg_value[arg_num] = argv[arg_num];
+    }
+    std::vector<std::string> moduleNameVec;
+
+    int orgArgNum = arg_num;
+    arg_value[arg_num++] = (char*)"-model-arrays=true";
+    arg_value[arg_num++] = (char*)"-pre-field-sensitive=false";
+    arg_value[arg_num++] = (char*)"-model-consts=true";
+    arg_value[arg_num++] = (char*)"-stat=false";
+    assert(arg_num == (orgArgNum + extraArgc) && "more extra arguments? Change the value of extraArgc");
+
+    moduleNameVec = OptionBase::parseOptions(arg_num,
+                                             arg_value,
+                                             "Software-Verification-Teaching Assignment 4 encoding benchmark",
+                                             "[options] <input-bitcode...>");
+    if (moduleNameVec.empty())
+        moduleNameVec = {"./Assignment-4/testcase/bc/test1.ll",
+                         "./Assignment-4/testcase/bc/test2.ll",
+                         "./Assignment-4/testcase/bc/test3.ll"};
+
+    for (const std::string& module : moduleNameVec)
+        benchModule(module);
+
+    delete[] arg_value;
+    return 0;
+}
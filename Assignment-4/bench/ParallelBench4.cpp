@@ -0,0 +1,115 @@
+//===- ParallelBench4.cpp -- Thread scaling benchmark for ParallelSSE -------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Report the paths/sec of ParallelSSE on each program for 1, 2, 4, ... threads up to the
+ * number of hardware threads, e.g., bench-4-parallel Assignment-4/testcase/bc/test1.ll
+ * (defaults to the Assignment-4 testcases if no program is given).
+ * SSE has to be completed first (the TODOs of Assignment-4.cpp), otherwise no path is translated.
+ */
+
+#include "ParallelSSE.h"
+#include "SVF-LLVM/LLVMUtil.h"
+#include "Util/CommandLine.h"
+#include "Util/Options.h"
+#include "WPA/Andersen.h"
+#include <chrono>
+#include <iomanip>
+
+using namespace SVF;
+using namespace SVFUtil;
+std::atomic<u32_t> SSE::assert_checked(0);
+
+/// Run ParallelSSE on one module with each thread count and print the throughput
+static void benchModule(const std::string& module) {
+    std::vector<std::string> moduleNameVec = {module};
+    LLVMModuleSet::getLLVMModuleSet()->buildSVFModule(moduleNameVec);
+
+    SVFIRBuilder builder;
+    SVFIR* svfir = builder.build();
+
+    CallGraph* callgraph = AndersenWaveDiff::createAndersenWaveDiff(svfir)->getCallGraph();
+    builder.updateCallGraph(callgraph);
+
+    /// ICFG
+    ICFG* icfg = svfir->getICFG();
+    icfg->updateCallGraph(callgraph);
+
+    u32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<u32_t> threadNums;
+    for (u32_t n = 1; n < maxThreads; n *= 2)
+        threadNums.push_back(n);
+    threadNums.push_back(maxThreads);
+
+    double baseRate = 0;
+    for (u32_t n : threadNums) {
+        ParallelSSE* sse = new ParallelSSE(svfir, icfg, n);
+        auto start = std::chrono::steady_clock::now();
+        sse->analyse();
+        auto end = std::chrono::steady_clock::now();
+        double sec = std::chrono::duration<double>(end - start).count();
+        double rate = sec > 0 ? sse->getPathNum() / sec : 0;
+        if (n == 1)
+            baseRate = rate;
+        std::cout << std::left << std::setw(40) << module << std::right << std::setw(4) << n << " threads"
+                  << std::setw(10) << sse->getPathNum() << " paths"
+                  << std::setw(12) << std::fixed << std::setprecision(1) << rate << " paths/sec"
+                  << std::setw(8) << std::setprecision(2) << (baseRate > 0 ? rate / baseRate : 0) << "x"
+                  << std::setw(8) << sse->getStealNum() << " steals\n";
+        delete sse;
+    }
+
+    SVF::LLVMModuleSet::releaseLLVMModuleSet();
+    SVF::SVFIR::releaseSVFIR();
+    NodeIDAllocator::unset();
+}
+
+int main(int argc, char** argv) {
+    int arg_num = 0;
+    int extraArgc = 4;
+    char** arg_value = new char*[argc + extraArgc];
+    for (; arg_num < argc; ++arg_num) {
+        arg_value[arg_num] = argv[arg_num];
+    }
+    std::vector<std::string> moduleNameVec;
+
+    int orgArgNum = arg_num;
+    arg_value[arg_num++] = (char*)"-model-arrays=true";
+    arg_value[arg_num++] = (char*)"-pre-field-sensitive=false";
+    arg_value[arg_num++] = (char*)"-model-consts=true";
+    arg_value[arg_num++] = (char*)"-stat=false";
+    assert(arg_num == (orgArgNum + extraArgc) && "more extra arguments? Change the value of extraArgc");
+
+    moduleNameVec = OptionBase::parseOptions(arg_num,
+                                             arg_value,
+                                             "Software-Verification-Teaching Assignment 4 parallel scaling benchmark",
+                                             "[options] <input-bitcode...>");
+    if (moduleNameVec.empty())
+        moduleNameVec = {"./Assignment-4/testcase/bc/test1.ll",
+                         "./Assignment-4/testcase/bc/test2.ll",
+                         "./Assignment-4/testcase/bc/test3.ll"};
+
+    for (const std::string& module : moduleNameVec)
+        benchModule(module);
+
+    delete[] arg_value;
+    return 0;
+}
@@ -0,0 +1,51 @@
+; ModuleID = './test5.ll'
+source_filename = "./test5.c"
+target datalayout = "e-m:o-i64:64-i128:128-n32:64-S128"
+target triple = "arm64-apple-macosx14.0.0"
+
+; Function Attrs: noinline nounwind ssp uwtable(sync)
+define i32 @main(i32 noundef %argc, ptr noundef %argv) #0 {
+entry:
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  store i32 1, ptr %a, align 4
+  store i32 2, ptr %b, align 4
+  %cmp = icmp sgt i32 %argc, 1
+  br i1 %cmp, label %if.then, label %if.else
+
+if.then:                                          ; preds = %entry
+  br label %if.end
+
+if.else:                                          ; preds = %entry
+  br label %if.end
+
+if.end:                                           ; preds = %if.else, %if.then
+  %p.0 = phi ptr [ %a, %if.then ], [ %b, %if.else ]
+  store i32 5, ptr %p.0, align 4
+  %cmp1 = icmp sgt i32 %argc, 1
+  br i1 %cmp1, label %if.then2, label %if.else4
+
+if.then2:                                         ; preds = %if.end
+  %0 = load i32, ptr %a, align 4
+  %cmp3 = icmp eq i32 %0, 5
+  call void @svf_assert(i1 noundef zeroext %cmp3)
+  br label %if.end6
+
+if.else4:                                         ; preds = %if.end
+  %1 = load i32, ptr %b, align 4
+  %cmp5 = icmp eq i32 %1, 5
+  call void @svf_assert(i1 noundef zeroext %cmp5)
+  br label %if.end6
+
+if.end6:                                          ; preds = %if.else4, %if.then2
+  ret i32 0
+}
+
+declare void @svf_assert(i1 noundef zeroext) #1
+
+attributes #0 = { noinline nounwind ssp uwtable(sync) "frame-pointer"="non-leaf" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="apple-m1" "target-features"="+aes,+crc,+crypto,+dotprod,+fp-armv8,+fp16fml,+fullfp16,+lse,+neon,+ras,+rcpc,+rdm,+sha2,+sha3,+sm4,+v8.1a,+v8.2a,+v8.3a,+v8.4a,+v8.5a,+v8a,+zcm,+zcz" }
+attributes #1 = { "frame-pointer"="non-leaf" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="apple-m1" "target-features"="+aes,+crc,+crypto,+dotprod,+fp-armv8,+fp16fml,+fullfp16,+lse,+neon,+ras,+rcpc,+rdm,+sha2,+sha3,+sm4,+v8.1a,+v8.2a,+v8.3a,+v8.4a,+v8.5a,+v8a,+zcm,+zcz" }
+
+!llvm.module.flags = !{!0}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
@@ -0,0 +1,16 @@
+//
+// The assertion is only reached after two iterations of the loop,
+// run with a loop unroll bound of at least 2
+//
+
+#include "stdbool.h"
+extern void svf_assert(bool);
+
+int main() {
+    int x = 0;
+    for (int i = 0; i < 2; i++) {
+        x = x + 3;
+    }
+    svf_assert(x == 6);
+    return 0;
+}
@@ -0,0 +1,23 @@
+//
+// p points to a on one path and to b on the other, so the states of the
+// two paths must not be merged into one with a single target for p
+//
+
+#include "stdbool.h"
+extern void svf_assert(bool);
+
+int main(int argc, char** argv) {
+    int a = 1;
+    int b = 2;
+    int* p;
+    if (argc > 1)
+        p = &a;
+    else
+        p = &b;
+    *p = 5;
+    if (argc > 1)
+        svf_assert(a == 5);
+    else
+        svf_assert(b == 5);
+    return 0;
+}
@@ -0,0 +1,17 @@
+//
+// The assertion is inside the callee, so check must not be summarized
+// and the assertion is checked in the calling context of each call
+//
+
+#include "stdbool.h"
+extern void svf_assert(bool);
+
+void check(int x) {
+    svf_assert(x > 0);
+}
+
+int main() {
+    check(1);
+    check(2);
+    return 0;
+}
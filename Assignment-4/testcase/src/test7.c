@@ -0,0 +1,16 @@
+//
+// The assertion is violated on the path where argc <= 1
+//
+
+#include "stdbool.h"
+extern void svf_assert(bool);
+
+int main(int argc, char** argv) {
+    int x;
+    if (argc > 1)
+        x = 2;
+    else
+        x = 1;
+    svf_assert(x == 2);
+    return 0;
+}
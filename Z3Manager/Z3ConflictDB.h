@@ -0,0 +1,128 @@
+//===- Z3ConflictDB.h -- Learned conflicts of path exploration --------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Learned conflicts of path exploration, i.e., sets of constraints known to be unsatisfiable together
+ *
+ * A conflict is learned from the unsat core of an infeasible query (see Z3Mgr::beginConstraintGroup),
+ * and identified by the AST ids of its constraints, which z3 hash-conses (the database keeps every
+ * constraint it refers to alive, so ids are never reused). Any path asserting all the constraints of
+ * a conflict is infeasible, whatever else it asserts. Conflicts are indexed by each of their constraints,
+ * so a new constraint only needs to be matched against the conflicts it belongs to.
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_Z3CONFLICTDB_H
+#define SOFTWARE_SECURITY_ANALYSIS_Z3CONFLICTDB_H
+
+#include "z3++.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace SVF {
+
+	class Z3ConflictDB {
+	 public:
+		typedef std::vector<unsigned> Conflict;	///< sorted AST ids
+		typedef std::unordered_map<unsigned, unsigned> AssertedIds;	///< AST id -> number of times asserted
+
+		Z3ConflictDB(unsigned maxConflicts = 1 << 14)
+		: capacity(maxConflicts)
+		, hits(0) {
+		}
+
+		/// Record a conflict, the database is emptied when it is full
+		inline void insert(const std::vector<z3::expr>& constraints) {
+			Conflict conflict;
+			conflict.reserve(constraints.size());
+			for (const z3::expr& e : constraints)
+				conflict.push_back(e.id());
+			std::sort(conflict.begin(), conflict.end());
+			conflict.erase(std::unique(conflict.begin(), conflict.end()), conflict.end());
+			if (conflict.empty() || !known.insert(conflict).second)
+				return;
+			if (conflicts.size() >= capacity)
+				clear();
+			for (const z3::expr& e : constraints)
+				pinned.emplace(e.id(), e);
+			unsigned idx = conflicts.size();
+			for (unsigned id : conflict)
+				byConstraint[id].push_back(idx);
+			conflicts.push_back(std::move(conflict));
+		}
+
+		/// Return true if a conflict containing the constraint id has all its other constraints asserted
+		inline bool match(unsigned id, const AssertedIds& asserted) {
+			auto it = byConstraint.find(id);
+			if (it == byConstraint.end())
+				return false;
+			for (unsigned idx : it->second) {
+				const Conflict& conflict = conflicts[idx];
+				bool all = std::all_of(conflict.begin(), conflict.end(), [&](unsigned c) {
+					return c == id || asserted.find(c) != asserted.end();
+				});
+				if (all) {
+					hits++;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		inline void clear() {
+			conflicts.clear();
+			byConstraint.clear();
+			known.clear();
+			pinned.clear();
+		}
+
+		/// Counters
+		///@{
+		inline unsigned getConflictNum() const {
+			return conflicts.size();
+		}
+		inline unsigned getHitNum() const {
+			return hits;
+		}
+		///@}
+
+	 private:
+		struct ConflictHash {
+			inline size_t operator()(const Conflict& conflict) const {
+				size_t h = conflict.size();
+				for (unsigned id : conflict)
+					h ^= id + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+				return h;
+			}
+		};
+
+		std::vector<Conflict> conflicts;
+		std::unordered_map<unsigned, std::vector<unsigned>> byConstraint;	///< AST id -> conflicts containing it
+		std::unordered_set<Conflict, ConflictHash> known;	///< recorded conflicts (compared id by id), to skip duplicates
+		std::unordered_map<unsigned, z3::expr> pinned;	///< keeps the constraints of the conflicts (and so their ids) alive
+		unsigned capacity;
+		unsigned hits;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_Z3CONFLICTDB_H
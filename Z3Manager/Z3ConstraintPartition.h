@@ -0,0 +1,161 @@
+//===- Z3ConstraintPartition.h -- Independent components of constraints -----//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Independent components of the asserted constraints
+ *
+ * Two constraints are dependent if they share a symbol (an uninterpreted constant, e.g., a ValVar or
+ * the initial memory loc2ValMap), and dependence is transitive. The partition is kept in a union-find
+ * over symbols, with union by rank and without path compression, so every union can be undone in
+ * O(1) when the solver scope that added its constraint is popped.
+ * A query (constraints && lit) is satisfiable iff the component of lit (the constraints sharing a symbol
+ * with lit, transitively) is satisfiable together with lit, provided the other constraints are.
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_Z3CONSTRAINTPARTITION_H
+#define SOFTWARE_SECURITY_ANALYSIS_Z3CONSTRAINTPARTITION_H
+
+#include "z3++.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace SVF {
+
+	class Z3ConstraintPartition {
+	 public:
+		typedef std::vector<unsigned> Symbols;	///< AST ids of the uninterpreted constants of a constraint
+
+		Z3ConstraintPartition(unsigned maxCachedExprs = 1 << 16)
+		: capacity(maxCachedExprs) {
+		}
+
+		/// Merge the components of the symbols of e
+		inline void add(const z3::expr& e) {
+			const Symbols& syms = getSymbols(e);
+			for (unsigned i = 1; i < syms.size(); i++)
+				unite(syms[0], syms[i]);
+		}
+
+		/// Union-find trail size, to undo the unions performed after it
+		inline unsigned mark() const {
+			return trail.size();
+		}
+
+		inline void undo(unsigned mark) {
+			while (trail.size() > mark) {
+				const Union& u = trail.back();
+				parent[u.child] = u.child;
+				if (u.rankIncreased)
+					rank[u.root]--;
+				trail.pop_back();
+			}
+		}
+
+		/// Collect the constraints of assertions in the component of lit, ground constraints are always collected
+		inline void getComponent(const std::vector<z3::expr>& assertions, const z3::expr& lit, std::vector<z3::expr>& component) {
+			component.clear();
+			std::unordered_set<unsigned> roots;
+			for (unsigned s : getSymbols(lit))
+				roots.insert(find(s));
+			for (const z3::expr& e : assertions) {
+				const Symbols& syms = getSymbols(e);
+				if (syms.empty() || roots.find(find(syms[0])) != roots.end())
+					component.push_back(e);
+			}
+		}
+
+		inline void clear() {
+			parent.clear();
+			rank.clear();
+			trail.clear();
+			symbolCache.clear();
+		}
+
+	 private:
+		struct Union {
+			unsigned child;		///< root attached to root
+			unsigned root;
+			bool rankIncreased;
+		};
+
+		inline unsigned find(unsigned s) {
+			auto it = parent.find(s);
+			if (it == parent.end())
+				return s;
+			while (it->second != s) {
+				s = it->second;
+				it = parent.find(s);
+			}
+			return s;
+		}
+
+		inline void unite(unsigned a, unsigned b) {
+			a = find(a);
+			b = find(b);
+			if (a == b)
+				return;
+			if (rank[a] < rank[b])
+				std::swap(a, b);
+			bool increased = rank[a] == rank[b];
+			parent[a] = a;
+			parent[b] = a;
+			if (increased)
+				rank[a]++;
+			trail.push_back(Union{b, a, increased});
+		}
+
+		/// Symbols of e, memoized per AST (the cache keeps e, and so its id, alive and is emptied when full)
+		inline const Symbols& getSymbols(const z3::expr& e) {
+			auto it = symbolCache.find(e.id());
+			if (it != symbolCache.end())
+				return it->second.second;
+			if (symbolCache.size() >= capacity)
+				symbolCache.clear();
+			Symbols syms;
+			std::unordered_set<unsigned> seen;
+			std::vector<z3::expr> worklist{e};
+			while (!worklist.empty()) {
+				z3::expr cur = worklist.back();
+				worklist.pop_back();
+				if (!cur.is_app() || !seen.insert(cur.id()).second)
+					continue;
+				if (cur.num_args() == 0) {
+					if (cur.decl().decl_kind() == Z3_OP_UNINTERPRETED)
+						syms.push_back(cur.id());
+					continue;
+				}
+				for (unsigned i = 0; i < cur.num_args(); i++)
+					worklist.push_back(cur.arg(i));
+			}
+			return symbolCache.emplace(e.id(), std::make_pair(e, std::move(syms))).first->second.second;
+		}
+
+		std::unordered_map<unsigned, unsigned> parent;	///< symbol -> parent, absent for a singleton
+		std::unordered_map<unsigned, unsigned> rank;
+		std::vector<Union> trail;
+		std::unordered_map<unsigned, std::pair<z3::expr, Symbols>> symbolCache;
+		unsigned capacity;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_Z3CONSTRAINTPARTITION_H
@@ -0,0 +1,179 @@
+//===- Z3FeasibilityCache.h -- Cache of branch feasibility queries ----------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Cache of branch feasibility queries, i.e., "is (path condition && literal) satisfiable?"
+ *
+ * A query is the set of the asserted constraints plus the branch literal, identified by the AST ids
+ * of its constraints. z3 hash-conses its ASTs, so structurally equal constraints have the same id
+ * (the cache keeps every constraint it refers to alive, so ids are never reused). A query is answered
+ * (1) by an exact match, (2) with unsat if the constraints of a cached unsat query are a subset of it,
+ * (3) with sat if it is a subset of a cached sat query (whose model satisfies all its constraints).
+ * Since a branch literal is only checked on a satisfiable path prefix, a cached query can only decide
+ * a query by subset/superset reasoning if both end with the same literal, so entries are indexed by literal.
+ * Exact matches are found by (literal, hash of the query). The subset/superset reasoning only scans the
+ * most recent entries of the literal (the ones of the paths explored last, which share most constraints).
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_Z3FEASIBILITYCACHE_H
+#define SOFTWARE_SECURITY_ANALYSIS_Z3FEASIBILITYCACHE_H
+
+#include "z3++.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace SVF {
+
+	class Z3FeasibilityCache {
+	 public:
+		typedef std::vector<unsigned> ConstraintSet;	///< sorted AST ids
+
+		Z3FeasibilityCache(unsigned maxEntries = 1 << 16, unsigned maxScanned = 64)
+		: capacity(maxEntries)
+		, scanLimit(maxScanned)
+		, exactHits(0)
+		, subsetHits(0)
+		, supersetHits(0)
+		, misses(0) {
+		}
+
+		/// Build the (sorted, duplicate-free) query of the asserted constraints plus lit
+		inline void makeQuery(const std::vector<z3::expr>& assertions, const z3::expr& lit, ConstraintSet& query) const {
+			query.clear();
+			query.reserve(assertions.size() + 1);
+			for (const z3::expr& e : assertions)
+				query.push_back(e.id());
+			query.push_back(lit.id());
+			std::sort(query.begin(), query.end());
+			query.erase(std::unique(query.begin(), query.end()), query.end());
+		}
+
+		/// Return true and set sat if the query can be decided from the cache
+		inline bool lookup(const ConstraintSet& query, const z3::expr& lit, bool& sat) {
+			auto eit = exact.find(Key(lit.id(), hashOf(query)));
+			if (eit != exact.end()) {
+				for (unsigned idx : eit->second) {
+					if (entries[idx].constraints == query) {
+						sat = entries[idx].sat;
+						exactHits++;
+						return true;
+					}
+				}
+			}
+			auto lit2Entries = byLiteral.find(lit.id());
+			if (lit2Entries != byLiteral.end()) {
+				const std::vector<unsigned>& bucket = lit2Entries->second;
+				unsigned scanned = std::min<size_t>(bucket.size(), scanLimit);
+				for (auto it = bucket.rbegin(); it != bucket.rbegin() + scanned; ++it) {
+					const Entry& entry = entries[*it];
+					if (!entry.sat && entry.constraints.size() <= query.size()
+					        && std::includes(query.begin(), query.end(), entry.constraints.begin(), entry.constraints.end())) {
+						sat = false;
+						subsetHits++;
+						return true;
+					}
+					if (entry.sat && entry.constraints.size() >= query.size()
+					        && std::includes(entry.constraints.begin(), entry.constraints.end(), query.begin(), query.end())) {
+						sat = true;
+						supersetHits++;
+						return true;
+					}
+				}
+			}
+			misses++;
+			return false;
+		}
+
+		/// Record the result of a query decided by the solver, the cache is emptied when it is full
+		inline void insert(const ConstraintSet& query, const std::vector<z3::expr>& assertions, const z3::expr& lit, bool sat) {
+			if (entries.size() >= capacity)
+				clear();
+			for (const z3::expr& e : assertions)
+				pinned.emplace(e.id(), e);
+			pinned.emplace(lit.id(), lit);
+			unsigned idx = entries.size();
+			entries.push_back(Entry{query, sat});
+			exact[Key(lit.id(), hashOf(query))].push_back(idx);
+			byLiteral[lit.id()].push_back(idx);
+		}
+
+		inline void clear() {
+			entries.clear();
+			exact.clear();
+			byLiteral.clear();
+			pinned.clear();
+		}
+
+		/// Counters
+		///@{
+		inline unsigned getExactHitNum() const {
+			return exactHits;
+		}
+		inline unsigned getSubsetHitNum() const {
+			return subsetHits;
+		}
+		inline unsigned getSupersetHitNum() const {
+			return supersetHits;
+		}
+		inline unsigned getHitNum() const {
+			return exactHits + subsetHits + supersetHits;
+		}
+		inline unsigned getMissNum() const {
+			return misses;
+		}
+		///@}
+
+	 private:
+		struct Entry {
+			ConstraintSet constraints;
+			bool sat;
+		};
+
+		typedef std::pair<unsigned, size_t> Key;	///< (AST id of the branch literal, hash of the query)
+		struct KeyHash {
+			inline size_t operator()(const Key& key) const {
+				return key.second ^ (key.first + 0x9e3779b97f4a7c15ULL + (key.second << 6) + (key.second >> 2));
+			}
+		};
+
+		static inline size_t hashOf(const ConstraintSet& query) {
+			size_t h = query.size();
+			for (unsigned id : query)
+				h ^= id + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+			return h;
+		}
+
+		std::vector<Entry> entries;
+		std::unordered_map<Key, std::vector<unsigned>, KeyHash> exact;	///< (literal, structural hash) -> entries
+		std::unordered_map<unsigned, std::vector<unsigned>> byLiteral;	///< AST id of the branch literal -> entries
+		std::unordered_map<unsigned, z3::expr> pinned;	///< keeps the constraints of the entries (and so their ids) alive
+		unsigned capacity;
+		unsigned scanLimit;	///< entries of a literal scanned for a subset/superset hit
+		unsigned exactHits;
+		unsigned subsetHits;
+		unsigned supersetHits;
+		unsigned misses;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_Z3FEASIBILITYCACHE_H
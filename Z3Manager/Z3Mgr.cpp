@@ -26,6 +26,7 @@
  */
 
 #include "Z3Mgr.h"
+#include <climits>
 #include <iomanip>
 #include <iostream>
 #include <set>
@@ -35,28 +36,219 @@ using namespace SVF;
 using namespace z3;
 using namespace std;
 
-/// Store and Select for Loc2ValMap, i.e., store and load
+int64_t Z3Mgr::getNumeralValue(const z3::expr& e) const {
+	assert(e.is_numeral() && "not a numeral?");
+	if (!e.is_bv())
+		return e.get_numeral_int64();
+	uint64_t bits = e.get_numeral_uint64();
+	if (e.get_sort().bv_size() == 32)
+		return (int32_t) (uint32_t) bits;
+	return (int64_t) bits;
+}
+
+z3::expr Z3Mgr::mkSRem(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? z3::srem(a, b) : a % b;
+}
+
+z3::expr Z3Mgr::mkXor(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? a ^ b : z3::bv2int(z3::int2bv(32, a) ^ z3::int2bv(32, b), 1);
+}
+
+z3::expr Z3Mgr::mkAnd(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? a & b : z3::bv2int(z3::int2bv(32, a) & z3::int2bv(32, b), 1);
+}
+
+z3::expr Z3Mgr::mkOr(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? a | b : z3::bv2int(z3::int2bv(32, a) | z3::int2bv(32, b), 1);
+}
+
+z3::expr Z3Mgr::mkAShr(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? z3::ashr(a, b) : z3::bv2int(z3::ashr(z3::int2bv(32, a), z3::int2bv(32, b)), 1);
+}
+
+z3::expr Z3Mgr::mkShl(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? z3::shl(a, b) : z3::bv2int(z3::shl(z3::int2bv(32, a), z3::int2bv(32, b)), 1);
+}
+
+/// Unsigned comparisons fall back to the (signed) arithmetic comparisons in the Int domain
+z3::expr Z3Mgr::mkUGt(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? z3::ugt(a, b) : a > b;
+}
+
+z3::expr Z3Mgr::mkUGe(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? z3::uge(a, b) : a >= b;
+}
+
+z3::expr Z3Mgr::mkULt(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? z3::ult(a, b) : a < b;
+}
+
+z3::expr Z3Mgr::mkULe(const z3::expr& a, const z3::expr& b) {
+	return isBVDomain() ? z3::ule(a, b) : a <= b;
+}
+
+/// Store and load on the memory partition of the dereferenced address.
+/// Concrete addresses and values are resolved without asking the solver
 z3::expr Z3Mgr::storeValue(const z3::expr loc, const z3::expr value) {
 	z3::expr deref = getEvalExpr(loc);
 	assert(isVirtualMemAddress(deref) && "Pointer operand is not a physical address?");
-	z3::expr loc2ValMap = varID2ExprMap[lastSlot];
-	loc2ValMap = z3::store(loc2ValMap, deref, value);
-	varID2ExprMap.set(lastSlot, loc2ValMap);
-	return loc2ValMap;
+	u32_t addr = getNumeralValue(deref);
+	int64_t concreteVal;
+	z3::expr contents = getConcreteValue(value, concreteVal) ? mkNumeral(concreteVal, value.get_sort()) : value;
+	auto it = memPartitions.find(addr);
+	if (!scopeMarks.empty())
+		memTrail.emplace_back(addr, it != memPartitions.end() ? it->second : z3::expr(ctx));
+	if (it != memPartitions.end())
+		it->second = contents;
+	else
+		memPartitions.emplace(addr, contents);
+	return contents;
 }
 
+/// A partition never stored to holds the initial contents of loc2ValMap at that address
 z3::expr Z3Mgr::loadValue(const z3::expr loc) {
 	z3::expr deref = getEvalExpr(loc);
 	assert(isVirtualMemAddress(deref) && "Pointer operand is not a physical address?");
-	z3::expr loc2ValMap = varID2ExprMap[lastSlot];
-	return z3::select(loc2ValMap, deref);
+	auto it = memPartitions.find(getNumeralValue(deref));
+	if (it != memPartitions.end())
+		return it->second;
+	return z3::select(varID2ExprMap[lastSlot], deref);
+}
+
+/// Partitions are compared by AST identity, which is cheap and enough to find the untouched ones
+u32_t Z3Mgr::getMemDiffNum(const MemPartitions& a, const MemPartitions& b) const {
+	u32_t diff = 0;
+	for (const auto& it : a) {
+		auto bit = b.find(it.first);
+		if (bit == b.end() || !z3::eq(it.second, bit->second))
+			diff++;
+	}
+	for (const auto& it : b) {
+		if (a.find(it.first) == a.end())
+			diff++;
+	}
+	return diff;
+}
+
+/// A partition missing on one side still holds the initial contents of loc2ValMap there
+void Z3Mgr::mergeMemPartitions(const z3::expr& cond, const MemPartitions& a, const MemPartitions& b, MemPartitions& res) {
+	res = a;
+	for (const auto& it : b) {
+		auto ait = res.find(it.first);
+		if (ait == res.end()) {
+			z3::expr init = z3::select(varID2ExprMap[lastSlot], getZ3Val(it.first));
+			res.emplace(it.first, z3::ite(cond, init, it.second));
+		}
+		else if (!z3::eq(ait->second, it.second))
+			ait->second = z3::ite(cond, ait->second, it.second);
+	}
+	for (auto& it : res) {
+		if (b.find(it.first) == b.end())
+			it.second = z3::ite(cond, it.second, z3::select(varID2ExprMap[lastSlot], getZ3Val(it.first)));
+	}
+}
+
+bool Z3Mgr::getConcreteValue(const z3::expr& e, int64_t& val) const {
+	if (e.is_numeral()) {
+		val = getNumeralValue(e);
+		return true;
+	}
+	if (e.is_const()) {
+		auto it = concreteBindings.find(e.id());
+		if (it != concreteBindings.end()) {
+			val = it->second;
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Only the first binding of a constant is kept, a conflicting one makes the constraints unsat anyway
+void Z3Mgr::recordConcreteBinding(const z3::expr& e) {
+	if (!e.is_eq() || e.num_args() != 2)
+		return;
+	for (u32_t i = 0; i < 2; i++) {
+		z3::expr var = e.arg(i);
+		int64_t val;
+		if (var.is_const() && !var.is_numeral() && getConcreteValue(e.arg(1 - i), val)
+		        && concreteBindings.find(var.id()) == concreteBindings.end()) {
+			concreteBindings[var.id()] = val;
+			bindingTrail.push_back(var.id());
+			return;
+		}
+	}
+}
+
+/// A null previous contents means the address had not been stored to before the scope
+void Z3Mgr::popScopes(u32_t n) {
+	for (; n > 0 && !scopeMarks.empty(); n--) {
+		ScopeMark mark = scopeMarks.back();
+		scopeMarks.pop_back();
+		while (bindingTrail.size() > mark.bindingTrailSize) {
+			concreteBindings.erase(bindingTrail.back());
+			bindingTrail.pop_back();
+		}
+		if (conflictLearning) {
+			for (u32_t i = mark.assertionsSize; i < assertions.size(); i++) {
+				auto it = assertedIds.find(assertions[i].id());
+				if (--it->second == 0)
+					assertedIds.erase(it);
+			}
+		}
+		assertions.erase(assertions.begin() + mark.assertionsSize, assertions.end());
+		partition.undo(mark.partitionMark);
+		assertionGroups.resize(mark.assertionsSize);
+		if (groups.size() > mark.groupsSize) {
+			groups.erase(groups.begin() + mark.groupsSize, groups.end());
+			groupOpen = false;
+		}
+		while (memTrail.size() > mark.memTrailSize) {
+			const std::pair<u32_t, z3::expr>& undo = memTrail.back();
+			if ((Z3_ast) undo.second == nullptr)
+				memPartitions.erase(undo.first);
+			else
+				memPartitions.find(undo.first)->second = undo.second;
+			memTrail.pop_back();
+		}
+	}
+}
+
+bool Z3Mgr::lookupFeasibility(const z3::expr& lit, CheckResult& res) {
+	if (!assertionsTracked)
+		return false;
+	feasibilityCache.makeQuery(assertions, lit, cacheQuery);
+	bool sat;
+	if (!feasibilityCache.lookup(cacheQuery, lit, sat))
+		return false;
+	res = sat ? Sat : Unsat;
+	return true;
+}
+
+void Z3Mgr::recordFeasibility(const z3::expr& lit, CheckResult res) {
+	if (!assertionsTracked || res == Unknown)
+		return;
+	Z3FeasibilityCache::ConstraintSet query;
+	feasibilityCache.makeQuery(assertions, lit, query);
+	feasibilityCache.insert(query, assertions, lit, res == Sat);
+}
+
+z3::expr Z3Mgr::mkNumeral(int64_t val, const z3::sort& s) {
+	return s.is_bv() ? ctx.bv_val(val, s.bv_size()) : ctx.int_val(val);
+}
+
+z3::expr Z3Mgr::translate(const z3::expr& e, z3::context& dst) {
+	if (&e.ctx() == &dst)
+		return e;
+	Z3_ast r = Z3_translate(e.ctx(), e, dst);
+	dst.check_error();
+	return z3::expr(dst, r);
 }
 
 /// Return int value from an expression if it is a numeral, otherwise return an approximate value
 s32_t Z3Mgr::z3Expr2NumValue(z3::expr e) {
 	z3::expr val = getEvalExpr(e);
 	if (val.is_numeral())
-		return val.get_numeral_int64();
+		return getNumeralValue(val);
 	else {
 		assert(false && "this expression is not numeral");
 		abort();
@@ -66,21 +258,257 @@ s32_t Z3Mgr::z3Expr2NumValue(z3::expr e) {
 /// It checks if the constraints added to the Z3 solver are satisfiable.
 /// If they are, it retrieves the model that satisfies these constraints
 /// and evaluates the given complex expression e within this model, returning the evaluated result
+/// A value fixed by the concrete bindings is returned without asking the solver, so concrete loads and stores
+/// never reach it (an unsat stack is reported by checkSolver on the branches and assertions)
 z3::expr Z3Mgr::getEvalExpr(z3::expr e) {
-	z3::check_result res = solver.check();
-	assert(res != z3::unsat && "unsatisfied constraints! Check your contradictory constraints added to the solver");
-	z3::model m = solver.get_model();
-	return m.eval(e);
+	int64_t val;
+	if (getConcreteValue(e, val))
+		return mkNumeral(val, e.get_sort());
+	concretizations++;
+	return getModel().eval(e);
+}
+
+/// Map z3's check result to a CheckResult and cache the model if the constraints are satisfiable
+Z3Mgr::CheckResult Z3Mgr::checkSolver() {
+	z3::check_result res;
+	if (groups.empty())
+		res = solver.check();
+	else {
+		z3::expr_vector assumptions(ctx);
+		for (const z3::expr& indicator : groups)
+			assumptions.push_back(indicator);
+		res = solver.check(assumptions);
+	}
+	if (res == z3::sat) {
+		cachedModel = solver.get_model();
+		modelValid = true;
+		modelEpoch = solverEpoch;
+		if (modelCaching)
+			modelCache.insertModel(cachedModel);
+		return Sat;
+	}
+	else if (res == z3::unsat) {
+		if (conflictLearning && assertionsTracked)
+			learnConflict();
+		return Unsat;
+	}
+	else
+		return Unknown;
+}
+
+/// The constraints of the groups outside the core are not needed for unsat, the ungrouped ones may be
+void Z3Mgr::learnConflict() {
+	z3::expr_vector core = solver.unsat_core();
+	std::vector<bool> inCore(groups.size(), false);
+	for (u32_t i = 0; i < core.size(); i++) {
+		for (u32_t g = 0; g < groups.size(); g++) {
+			if (z3::eq(core[i], groups[g]))
+				inCore[g] = true;
+		}
+	}
+	std::vector<z3::expr> conflict;
+	for (u32_t i = 0; i < assertions.size(); i++) {
+		if (assertionGroups[i] < 0 || inCore[assertionGroups[i]])
+			conflict.push_back(assertions[i]);
+	}
+	conflictDB.insert(conflict);
+}
+
+void Z3Mgr::setConflictLearning(bool learn) {
+	conflictLearning = learn;
+	assertedIds.clear();
+	if (learn) {
+		for (const z3::expr& e : assertions)
+			assertedIds[e.id()]++;
+	}
+	applySolverLimits();
+}
+
+/// A group at depth k always uses the indicator "group!k": the constraints guarded by an indicator
+/// are removed together with its group (by popSolver or resetSolver), so indicators can be reused
+void Z3Mgr::beginConstraintGroup() {
+	assert(conflictLearning && !groupOpen && "constraint groups cannot be nested");
+	std::string name = "group!" + std::to_string(groups.size());
+	groups.push_back(ctx.bool_const(name.c_str()));
+	groupOpen = true;
+}
+
+bool Z3Mgr::endConstraintGroup() {
+	assert(groupOpen && "endConstraintGroup without beginConstraintGroup?");
+	groupOpen = false;
+	if (!assertionsTracked)
+		return false;
+	for (u32_t i = assertions.size(); i > 0 && assertionGroups[i - 1] == (s32_t) groups.size() - 1; i--) {
+		if (conflictDB.match(assertions[i - 1].id(), assertedIds))
+			return true;
+	}
+	return false;
+}
+
+bool Z3Mgr::isConflicting(const z3::expr& lit) {
+	return conflictLearning && assertionsTracked && conflictDB.match(lit.id(), assertedIds);
+}
+
+/// The partition is rebuilt from the assertions in order, and the mark of each open scope is reset to
+/// the partition of the assertions made before it, so popping a scope still undoes exactly its unions
+void Z3Mgr::setIndependenceSplitting(bool split) {
+	independenceSplitting = split;
+	partition.clear();
+	if (split) {
+		u32_t scope = 0;
+		for (u32_t i = 0; i <= assertions.size(); i++) {
+			for (; scope < scopeMarks.size() && scopeMarks[scope].assertionsSize == i; scope++)
+				scopeMarks[scope].partitionMark = partition.mark();
+			if (i < assertions.size())
+				partition.add(assertions[i]);
+		}
+	}
+}
+
+void Z3Mgr::setModelCaching(bool cache) {
+	modelCaching = cache;
+	modelCache.clear();
+	applySolverLimits();
+}
+
+/// The query is checked in a fresh scope of componentSolver (components change with every push/pop
+/// of the main solver, so nothing is kept between queries), and only its Sat/Unsat result is recorded
+Z3Mgr::CheckResult Z3Mgr::checkIndependent(const z3::expr& lit, bool useCache) {
+	if (!usesComponentSolver() || !assertionsTracked) {
+		pushSolver();
+		addToSolver(lit);
+		CheckResult res = checkSolver();
+		popSolver();
+		return res;
+	}
+	if (independenceSplitting)
+		partition.getComponent(assertions, lit, component);
+	else
+		component = assertions;
+	Z3FeasibilityCache::ConstraintSet query;
+	feasibilityCache.makeQuery(component, lit, query);
+	bool sat;
+	if (useCache && feasibilityCache.lookup(query, lit, sat))
+		return sat ? Sat : Unsat;
+	if (modelCaching) {
+		if (modelCache.refutes(component, lit))
+			return Unsat;
+		if (modelCache.findModel(component, lit))
+			return Sat;
+		modelCache.countMiss();
+	}
+	if (independenceSplitting) {
+		independentQueries++;
+		droppedConstraints += assertions.size() - component.size();
+	}
+	CheckResult res;
+	if (modelCaching)
+		res = checkWithCore(lit);
+	else {
+		componentSolver.push();
+		for (const z3::expr& e : component)
+			componentSolver.add(e);
+		componentSolver.add(lit);
+		z3::check_result r = componentSolver.check();
+		componentSolver.pop();
+		res = r == z3::sat ? Sat : r == z3::unsat ? Unsat : Unknown;
+	}
+	if (res != Unknown)
+		feasibilityCache.insert(query, component, lit, res == Sat);
+	return res;
+}
+
+/// The last indicator guards lit. The indicator names only depend on the position in the query, which is
+/// enough since the guarded constraints are popped with the scope of the query
+Z3Mgr::CheckResult Z3Mgr::checkWithCore(const z3::expr& lit) {
+	while (coreIndicators.size() <= component.size()) {
+		std::string name = "core!" + std::to_string(coreIndicators.size());
+		coreIndicators.push_back(ctx.bool_const(name.c_str()));
+	}
+	componentSolver.push();
+	z3::expr_vector assumptions(ctx);
+	for (u32_t i = 0; i <= component.size(); i++) {
+		componentSolver.add(z3::implies(coreIndicators[i], i < component.size() ? component[i] : lit));
+		assumptions.push_back(coreIndicators[i]);
+	}
+	z3::check_result res = componentSolver.check(assumptions);
+	if (res == z3::sat)
+		modelCache.insertModel(componentSolver.get_model());
+	else if (res == z3::unsat) {
+		std::unordered_map<u32_t, u32_t> position;
+		for (u32_t i = 0; i <= component.size(); i++)
+			position[coreIndicators[i].id()] = i;
+		z3::expr_vector core = componentSolver.unsat_core();
+		std::vector<z3::expr> coreConstraints;
+		for (u32_t i = 0; i < core.size(); i++) {
+			u32_t pos = position.at(core[i].id());
+			coreConstraints.push_back(pos < component.size() ? component[pos] : lit);
+		}
+		modelCache.insertCore(coreConstraints);
+	}
+	componentSolver.pop();
+	return res == z3::sat ? Sat : res == z3::unsat ? Unsat : Unknown;
+}
+
+/// Z3 uses UINT_MAX for an unbounded timeout and memory, and 0 for an unbounded rlimit
+void Z3Mgr::applySolverLimits() {
+	z3::params p(ctx);
+	p.set("timeout", timeout == 0 ? UINT_MAX : timeout);
+	p.set("rlimit", rlimit);
+	p.set("max_memory", maxMemory == 0 ? UINT_MAX : maxMemory);
+	p.set("core.minimize", modelCaching);
+	componentSolver.set(p);
+	p.set("core.minimize", conflictLearning);
+	solver.set(p);
+}
+
+/// The solver is only re-checked if an add/push/pop/reset happened since the last model was retrieved.
+/// Without a model (unsat, or z3 gave up without a partial one) the model is empty, see hasModel
+const z3::model& Z3Mgr::getModel() {
+	if (modelEpoch != solverEpoch) {
+		CheckResult res = checkSolver();
+		assert(res != Unsat && "unsatisfied constraints! Check your contradictory constraints added to the solver");
+		if (res != Sat) {
+			cachedModel = z3::model(ctx);
+			modelValid = false;
+			/// z3 may still provide a (partial) model if it gave up
+			if (res == Unknown) {
+				try {
+					cachedModel = solver.get_model();
+					modelValid = true;
+				}
+				catch (const z3::exception&) {
+				}
+			}
+			modelEpoch = solverEpoch;
+		}
+	}
+	return cachedModel;
+}
+
+/// Evaluate a batch of expressions under a single model
+void Z3Mgr::evalAll(const z3::expr_vector& exprs, Z3EvalTable& table) {
+	const z3::model& m = getModel();
+	table.resize(exprs.size());
+	for (u32_t i = 0; i < exprs.size(); i++) {
+		z3::expr e = m.eval(exprs[i]);
+		table[i].isNumeral = e.is_numeral();
+		table[i].value = table[i].isNumeral ? getNumeralValue(e) : 0;
+	}
 }
 
 /// Print all expressions' values after evaluation
 void Z3Mgr::printExprValues() {
 	std::cout.flags(std::ios::left);
 	std::cout << "-----------Var and Value-----------\n";
+	z3::expr_vector exprs(ctx);
+	for (u32_t i = 0; i < lastSlot; i++)
+		exprs.push_back(varID2ExprMap[i]);
+	Z3EvalTable table;
+	evalAll(exprs, table);
 	for (u32_t i = 0; i < lastSlot; i++) {
-		expr e = getEvalExpr(varID2ExprMap[i]);
-		if (e.is_numeral()) {
-			s32_t value = e.get_numeral_int64();
+		if (table[i].isNumeral) {
+			s32_t value = table[i].value;
 			std::stringstream exprName;
 			exprName << "Var" << i;
 			std::cout << std::setw(25) << exprName.str();
@@ -29,6 +29,12 @@
 #define SOFTWARE_SECURITY_ANALYSIS_Z3MGR_H
 
 #include "z3++.h"
+#include "Z3FeasibilityCache.h"
+#include "Z3ConflictDB.h"
+#include "Z3ConstraintPartition.h"
+#include "Z3ModelCache.h"
+#include <unordered_map>
+#include <vector>
 
 namespace SVF {
 
@@ -41,27 +47,118 @@ namespace SVF {
 #define AddressMask 0x7f000000
 #define FlippedAddressMask (AddressMask ^ 0xffffffff)
 
+/// Default value domain of Z3Mgr: 0 for the Int encoding, 32 or 64 for a pure bit-vector (QF_ABV) encoding
+#ifndef Z3_BV_WIDTH
+#	define Z3_BV_WIDTH 0
+#endif
+
 	typedef unsigned u32_t;
 	typedef signed s32_t;
 
+	/// Value of an expression evaluated under a model, value is only meaningful if isNumeral is true
+	struct Z3EvalValue {
+		bool isNumeral;
+		s32_t value;
+	};
+	typedef std::vector<Z3EvalValue> Z3EvalTable;
+
 	/// Z3 manager interface
 	class Z3Mgr {
 	 public:
+		/// Virtual address -> current contents of the memory partition
+		typedef std::unordered_map<u32_t, z3::expr> MemPartitions;
+
+		/// Three-valued result of a solver query
+		enum CheckResult {
+			Sat,
+			Unsat,
+			Unknown	///< the solver gave up, e.g., because a resource limit was hit
+		};
+
+		/// Value domain of program values: unbounded integers, or 32/64-bit bit-vectors with wrap-around semantics
+		enum ValueDomain {
+			IntDomain = 0,
+			BV32Domain = 32,
+			BV64Domain = 64
+		};
+
 		/// Constructor
-		Z3Mgr(u32_t numOfMapElems)
-		: solver(ctx)
+		Z3Mgr(u32_t numOfMapElems, ValueDomain domain = (ValueDomain) Z3_BV_WIDTH)
+		: solver(domain == IntDomain ? z3::solver(ctx) : z3::solver(ctx, "QF_ABV"))
+		, componentSolver(domain == IntDomain ? z3::solver(ctx) : z3::solver(ctx, "QF_ABV"))
 		, varID2ExprMap(ctx)
-		, lastSlot(numOfMapElems) {
+		, lastSlot(numOfMapElems)
+		, valueDomain(domain)
+		, cachedModel(ctx)
+		, modelValid(false)
+		, solverEpoch(1)
+		, modelEpoch(0)
+		, timeout(0)
+		, rlimit(0)
+		, maxMemory(0)
+		, assertionsTracked(true)
+		, concretizations(0)
+		, conflictLearning(false)
+		, groupOpen(false)
+		, independenceSplitting(false)
+		, independentQueries(0)
+		, droppedConstraints(0)
+		, modelCaching(false) {
 			resetZ3ExprMap();
 		}
 
+		/// The loc2ValMap in lastSlot is never updated, it only provides the (unconstrained) initial memory contents
 		inline void resetZ3ExprMap() {
 			varID2ExprMap.resize(lastSlot + 1);
-			z3::expr loc2ValMap = ctx.constant("loc2ValMap", ctx.array_sort(ctx.int_sort(), ctx.int_sort()));
+			z3::expr loc2ValMap = ctx.constant("loc2ValMap", ctx.array_sort(getValSort(), getValSort()));
 			updateZ3Expr(lastSlot, loc2ValMap);
+			memPartitions.clear();
+			memTrail.clear();
 		}
 
-		/// Store and Select for Loc2ValMap, i.e., store and load
+		/// Value domain
+		///@{
+		inline ValueDomain getValueDomain() const {
+			return valueDomain;
+		}
+		inline bool isBVDomain() const {
+			return valueDomain != IntDomain;
+		}
+		/// Sort of program values (Int or a bit-vector of the domain's width)
+		inline z3::sort getValSort() {
+			return isBVDomain() ? ctx.bv_sort(valueDomain) : ctx.int_sort();
+		}
+		/// Numeral of the value sort
+		inline z3::expr getZ3Val(int64_t val) {
+			return isBVDomain() ? ctx.bv_val(val, valueDomain) : ctx.int_val(val);
+		}
+		/// Symbolic constant of the value sort
+		inline z3::expr getZ3Const(const char* name) {
+			return ctx.constant(name, getValSort());
+		}
+		/// Return the signed value of a numeral, bit-vectors are interpreted in two's complement
+		int64_t getNumeralValue(const z3::expr& e) const;
+		///@}
+
+		/// Operators whose encoding depends on the value domain.
+		/// Native bit-vector operators are used for the bit-vector domains;
+		/// the Int domain uses (overflow-free) arithmetic and 32-bit int2bv/bv2int conversions for bitwise operators
+		///@{
+		z3::expr mkSRem(const z3::expr& a, const z3::expr& b);
+		z3::expr mkXor(const z3::expr& a, const z3::expr& b);
+		z3::expr mkAnd(const z3::expr& a, const z3::expr& b);
+		z3::expr mkOr(const z3::expr& a, const z3::expr& b);
+		z3::expr mkAShr(const z3::expr& a, const z3::expr& b);
+		z3::expr mkShl(const z3::expr& a, const z3::expr& b);
+		z3::expr mkUGt(const z3::expr& a, const z3::expr& b);
+		z3::expr mkUGe(const z3::expr& a, const z3::expr& b);
+		z3::expr mkULt(const z3::expr& a, const z3::expr& b);
+		z3::expr mkULe(const z3::expr& a, const z3::expr& b);
+		///@}
+
+		/// Store and load. Memory is partitioned per base object or field: the dereferenced pointer is
+		/// always a concrete virtual address, so each address keeps its own contents instead of a
+		/// store(store(...)) chain over a single loc2ValMap. storeValue returns the new contents of the partition
 		z3::expr storeValue(const z3::expr loc, const z3::expr value);
 
 		z3::expr loadValue(const z3::expr loc);
@@ -112,18 +209,222 @@ namespace SVF {
 		/// and evaluates the given complex expression e within this model, returning the evaluated result
 		z3::expr getEvalExpr(z3::expr e);
 
+		/// Check the solver once, retrieve one model and evaluate every expression of exprs against it.
+		/// The i-th entry of table holds the value of exprs[i]
+		void evalAll(const z3::expr_vector& exprs, Z3EvalTable& table);
+
+		/// Check the satisfiability of the current assertion stack under the configured resource limits.
+		/// The model of a Sat result is cached for the current solver epoch
+		CheckResult checkSolver();
+
+		/// Per-query resource limits, 0 means unbounded
+		///@{
+		/// Wall-clock limit in milliseconds
+		inline void setTimeout(u32_t ms) {
+			timeout = ms;
+			applySolverLimits();
+		}
+		/// Z3 resource limit (deterministic, machine-independent unit of work)
+		inline void setRLimit(u32_t limit) {
+			rlimit = limit;
+			applySolverLimits();
+		}
+		/// Memory limit in megabytes
+		inline void setMaxMemory(u32_t mb) {
+			maxMemory = mb;
+			applySolverLimits();
+		}
+		inline u32_t getTimeout() const {
+			return timeout;
+		}
+		inline u32_t getRLimit() const {
+			return rlimit;
+		}
+		inline u32_t getMaxMemory() const {
+			return maxMemory;
+		}
+		///@}
+
+		/// Return the model of the current assertion stack, reusing the cached one until the solver epoch changes
+		const z3::model& getModel();
+		/// Return false if getModel has no model of the current assertion stack (it is then empty)
+		inline bool hasModel() {
+			getModel();
+			return modelValid;
+		}
+
 		/// Print all expressions' values after evaluation
 		void printExprValues();
 
 		void printZ3Exprs();
 
+		/// Solver updates, each of which starts a new solver epoch and invalidates the cached model
+		///@{
+		inline void addToSolver(z3::expr e) {
+			if (groupOpen) {
+				solver.add(z3::implies(groups.back(), e));
+				assertionGroups.push_back(groups.size() - 1);
+			}
+			else {
+				solver.add(e);
+				assertionGroups.push_back(-1);
+			}
+			assertions.push_back(e);
+			if (conflictLearning)
+				assertedIds[e.id()]++;
+			if (independenceSplitting)
+				partition.add(e);
+			recordConcreteBinding(e);
+			++solverEpoch;
+		}
+
+		/// A solver scope also scopes the concrete bindings and the memory partitions,
+		/// i.e., popSolver undoes the stores performed since the matching pushSolver
+		inline void pushSolver() {
+			solver.push();
+			scopeMarks.push_back(ScopeMark{(u32_t) bindingTrail.size(), (u32_t) memTrail.size(), (u32_t) assertions.size(), (u32_t) groups.size(), partition.mark()});
+			++solverEpoch;
+		}
+
+		inline void popSolver(u32_t n = 1) {
+			solver.pop(n);
+			popScopes(n);
+			++solverEpoch;
+		}
+
+		inline void resetSolver() {
+			solver.reset();
+			applySolverLimits();
+			clearConcreteBindings();
+			scopeMarks.clear();
+			memTrail.clear();
+			assertions.clear();
+			assertionGroups.clear();
+			assertedIds.clear();
+			groups.clear();
+			groupOpen = false;
+			partition.clear();
+			assertionsTracked = true;
+			++solverEpoch;
+		}
+		///@}
+
+		/// Conflict learning: the constraints added between beginConstraintGroup and endConstraintGroup form a group
+		/// (e.g., one ICFGEdge), and the groups in the unsat core of an infeasible check are learned as a conflict
+		///@{
+		void setConflictLearning(bool learn);
+		inline bool isConflictLearning() const {
+			return conflictLearning;
+		}
+		void beginConstraintGroup();
+		/// Close the current group, return true if the asserted constraints now contain a learned conflict
+		bool endConstraintGroup();
+		/// Return true if asserting lit would complete a learned conflict
+		bool isConflicting(const z3::expr& lit);
+		inline const Z3ConflictDB& getConflictDB() const {
+			return conflictDB;
+		}
+		///@}
+
+		/// Independence splitting: checkIndependent only solves the constraints sharing a symbol with the query literal
+		/// (Z3ConstraintPartition), the others are assumed satisfiable, e.g., each branch was checked before being added
+		///@{
+		/// May be switched inside solver scopes, the partition is then rebuilt from the asserted constraints
+		void setIndependenceSplitting(bool split);
+		inline bool isIndependenceSplitting() const {
+			return independenceSplitting;
+		}
+		/// Is the conjunction of the asserted constraints and lit satisfiable? A full check while neither splitting
+		/// nor model caching is on (or the assertions are not tracked), decided components come from the feasibility cache
+		CheckResult checkIndependent(const z3::expr& lit, bool useCache = true);
+		/// Return true if checkIndependent checks its queries on a separate solver
+		inline bool usesComponentSolver() const {
+			return independenceSplitting || modelCaching;
+		}
+		/// Number of queries checked on a component
+		inline u32_t getIndependentQueryNum() const {
+			return independentQueries;
+		}
+		/// Total number of constraints left out of the component queries
+		inline uint64_t getDroppedConstraintNum() const {
+			return droppedConstraints;
+		}
+		///@}
+
+		/// Counterexample cache (Z3ModelCache) of checkIndependent: a query is only solved if no cached unsat core
+		/// refutes it and no recent model satisfies it
+		///@{
+		void setModelCaching(bool cache);
+		inline bool isModelCaching() const {
+			return modelCaching;
+		}
+		inline const Z3ModelCache& getModelCache() const {
+			return modelCache;
+		}
+		///@}
+
+		/// Branch feasibility cache: is the conjunction of the asserted constraints and lit satisfiable?
+		/// Only used while all assertions went through addToSolver, i.e., until getSolver is called (and the solver is reset)
+		///@{
+		/// Return true and set res (Sat or Unsat) if the cache decides the query
+		bool lookupFeasibility(const z3::expr& lit, CheckResult& res);
+		/// Record the result of the query, as checked by the solver, Unknown results are not recorded
+		void recordFeasibility(const z3::expr& lit, CheckResult res);
+		inline const Z3FeasibilityCache& getFeasibilityCache() const {
+			return feasibilityCache;
+		}
+		///@}
+
+		/// Constraints on the solver's assertion stack, in the order they were added
+		inline const std::vector<z3::expr>& getAssertions() const {
+			return assertions;
+		}
+
+		/// Number of expressions getEvalExpr had to concretize with a model, i.e., whose value is not fixed
+		/// by the concrete bindings, so the translation so far holds for one value of them only
+		inline u32_t getConcretizationNum() const {
+			return concretizations;
+		}
+
+		/// Memory states, e.g., for merging the states of two paths
+		///@{
+		inline const MemPartitions& getMemPartitions() const {
+			return memPartitions;
+		}
+		/// Replace the whole memory, only allowed outside of any solver scope (the scopes only undo single stores)
+		inline void setMemPartitions(const MemPartitions& mem) {
+			assert(scopeMarks.empty() && "replacing the memory inside a solver scope?");
+			memPartitions = mem;
+		}
+		/// Number of partitions whose contents differ between a and b
+		u32_t getMemDiffNum(const MemPartitions& a, const MemPartitions& b) const;
+		/// Merged memory holding the contents of a where cond holds and of b otherwise
+		void mergeMemPartitions(const z3::expr& cond, const MemPartitions& a, const MemPartitions& b, MemPartitions& res);
+		///@}
+
+		/// Concrete fast path: return true if e is a numeral, or a constant equated to a numeral
+		/// (directly or through other constants) by an assertion added via addToSolver, and set val to its value
+		bool getConcreteValue(const z3::expr& e, int64_t& val) const;
+
+		/// Return the solver epoch, i.e., the number of add/push/pop/reset performed so far
+		inline u32_t getSolverEpoch() const {
+			return solverEpoch;
+		}
+
+		/// Direct access to the solver may change its assertion stack, so the cached model
+		/// and the concrete bindings (which could be popped behind our back) are invalidated
 		inline z3::solver& getSolver() {
+			++solverEpoch;
+			clearConcreteBindings();
+			assertionsTracked = false;
 			return solver;
 		}
 
 		inline z3::context& getCtx() {
 			return ctx;
 		}
+		/// Copy of e in the context dst (e.g., of another Z3Mgr), nothing else may use the context of e meanwhile
+		static z3::expr translate(const z3::expr& e, z3::context& dst);
 
 		inline void clearVarID2ExprMap() {
 			while (!varID2ExprMap.empty())
@@ -135,10 +436,73 @@ namespace SVF {
 	 protected:
 		z3::context ctx;
 		z3::solver solver;
+		z3::solver componentSolver;	///< solver of the component queries of checkIndependent
 
 	 private:
+		/// Pass the resource limits to both solvers, and core minimization to the solvers whose cores are used
+		void applySolverLimits();
+
+		/// Check component && lit on componentSolver, caching the model or the unsat core of the result
+		CheckResult checkWithCore(const z3::expr& lit);
+
+		/// Learn the conflict of the last (unsat) check from its unsat core
+		void learnConflict();
+
+		/// Bind a constant to a value if e is an equality between the constant and a concrete expression
+		void recordConcreteBinding(const z3::expr& e);
+
+		/// Undo the bindings and stores recorded in the last n solver scopes
+		void popScopes(u32_t n);
+
+		inline void clearConcreteBindings() {
+			concreteBindings.clear();
+			bindingTrail.clear();
+		}
+
+		/// Numeral of value val with sort s
+		z3::expr mkNumeral(int64_t val, const z3::sort& s);
+
 		z3::expr_vector varID2ExprMap;
 		u32_t lastSlot;
+		ValueDomain valueDomain;
+		MemPartitions memPartitions;
+		std::unordered_map<u32_t, int64_t> concreteBindings;	///< AST id of a constant -> its asserted value
+		std::vector<u32_t> bindingTrail;	///< bound AST ids in binding order, for undoing bindings on pop
+		std::vector<std::pair<u32_t, z3::expr>> memTrail;	///< (address, previous contents or null expr) of stores inside a scope
+		struct ScopeMark {
+			u32_t bindingTrailSize;
+			u32_t memTrailSize;
+			u32_t assertionsSize;
+			u32_t groupsSize;
+			u32_t partitionMark;
+		};
+		std::vector<ScopeMark> scopeMarks;	///< trail sizes at each push
+		z3::model cachedModel;	///< model obtained at modelEpoch
+		bool modelValid;	///< false if no model was available at modelEpoch
+		u32_t solverEpoch;	///< bumped on every change of the solver's assertion stack
+		u32_t modelEpoch;	///< solver epoch of cachedModel (stale if different from solverEpoch)
+		u32_t timeout;		///< per-query timeout in milliseconds (0: unbounded)
+		u32_t rlimit;		///< per-query resource limit (0: unbounded)
+		u32_t maxMemory;	///< memory limit in megabytes (0: unbounded)
+		std::vector<z3::expr> assertions;	///< constraints on the solver's assertion stack
+		bool assertionsTracked;	///< false if the solver may hold constraints not in assertions
+		Z3FeasibilityCache feasibilityCache;
+		Z3FeasibilityCache::ConstraintSet cacheQuery;	///< buffer for the queries of lookupFeasibility
+		u32_t concretizations;
+		bool conflictLearning;
+		bool groupOpen;		///< constraints are currently added to groups.back()
+		std::vector<z3::expr> groups;	///< indicator of each constraint group, the indicator of a group only depends on its depth
+		std::vector<s32_t> assertionGroups;	///< group of each constraint in assertions, -1 if ungrouped
+		Z3ConflictDB::AssertedIds assertedIds;	///< AST ids of assertions (maintained while conflict learning is on)
+		Z3ConflictDB conflictDB;
+		bool independenceSplitting;
+		Z3ConstraintPartition partition;	///< components of assertions (maintained while independence splitting is on)
+		std::vector<z3::expr> component;	///< buffer for the component of checkIndependent
+		u32_t independentQueries;
+		uint64_t droppedConstraints;
+		bool modelCaching;
+		Z3ModelCache modelCache;
+		std::vector<z3::expr> coreIndicators;	///< indicator of the i-th constraint of a checkIndependent query
 	};
 
 } // namespace SVF
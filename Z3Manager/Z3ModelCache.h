@@ -0,0 +1,187 @@
+//===- Z3ModelCache.h -- Counterexample cache of feasibility queries ----------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013-2022>  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * Counterexample cache of feasibility queries, i.e., "is (constraints && literal) satisfiable?"
+ *
+ * The models of recent satisfiable queries are kept, and a new query holding under one of them is sat
+ * without calling the solver: sibling paths share most of their constraints, so the model of a path
+ * often satisfies the next branch taken. The result of evaluating a constraint under a model is memoized
+ * per model (by AST id, the cache keeps every constraint it refers to alive, so ids are never reused).
+ * The unsat cores of refuted queries are kept too, and a query containing all the constraints of a core
+ * is unsat. Since a literal is only checked on a satisfiable set of constraints, the core of a refuted
+ * query contains its literal, so cores are indexed by each of their constraints and looked up by literal.
+ */
+
+#ifndef SOFTWARE_SECURITY_ANALYSIS_Z3MODELCACHE_H
+#define SOFTWARE_SECURITY_ANALYSIS_Z3MODELCACHE_H
+
+#include "z3++.h"
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace SVF {
+
+	class Z3ModelCache {
+	 public:
+		typedef std::vector<unsigned> Core;	///< sorted AST ids
+
+		Z3ModelCache(unsigned maxModels = 16, unsigned maxCores = 1 << 14)
+		: modelCapacity(maxModels)
+		, coreCapacity(maxCores)
+		, modelHits(0)
+		, coreHits(0)
+		, misses(0) {
+		}
+
+		/// Keep m, the oldest model is dropped when the cache is full
+		inline void insertModel(const z3::model& m) {
+			if (models.size() >= modelCapacity)
+				models.pop_back();
+			models.push_front(Entry{m, {}});
+		}
+
+		/// Record the unsat core of a refuted query, the cores are emptied when full
+		inline void insertCore(const std::vector<z3::expr>& constraints) {
+			Core core;
+			core.reserve(constraints.size());
+			for (const z3::expr& e : constraints)
+				core.push_back(e.id());
+			std::sort(core.begin(), core.end());
+			core.erase(std::unique(core.begin(), core.end()), core.end());
+			if (core.empty())
+				return;
+			if (cores.size() >= coreCapacity) {
+				cores.clear();
+				byConstraint.clear();
+				pinned.clear();
+			}
+			for (const z3::expr& e : constraints)
+				pinned.emplace(e.id(), e);
+			unsigned idx = cores.size();
+			for (unsigned id : core)
+				byConstraint[id].push_back(idx);
+			cores.push_back(std::move(core));
+		}
+
+		/// Return true if a cached model satisfies lit and all the constraints, the model found is moved to the front
+		inline bool findModel(const std::vector<z3::expr>& constraints, const z3::expr& lit) {
+			for (auto it = models.begin(); it != models.end(); ++it) {
+				if (!holds(*it, lit))
+					continue;
+				bool all = std::all_of(constraints.begin(), constraints.end(), [&](const z3::expr& e) {
+					return holds(*it, e);
+				});
+				if (all) {
+					if (it != models.begin()) {
+						Entry entry = std::move(*it);
+						models.erase(it);
+						models.push_front(std::move(entry));
+					}
+					modelHits++;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/// Return true if a core containing lit is included in the constraints (plus lit)
+		inline bool refutes(const std::vector<z3::expr>& constraints, const z3::expr& lit) {
+			auto it = byConstraint.find(lit.id());
+			if (it == byConstraint.end())
+				return false;
+			std::unordered_set<unsigned> ids;
+			for (const z3::expr& e : constraints)
+				ids.insert(e.id());
+			for (unsigned idx : it->second) {
+				const Core& core = cores[idx];
+				bool all = std::all_of(core.begin(), core.end(), [&](unsigned c) {
+					return c == lit.id() || ids.find(c) != ids.end();
+				});
+				if (all) {
+					coreHits++;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/// Count a query neither cached models nor cores could decide
+		inline void countMiss() {
+			misses++;
+		}
+
+		inline void clear() {
+			models.clear();
+			cores.clear();
+			byConstraint.clear();
+			pinned.clear();
+		}
+
+		/// Counters
+		///@{
+		inline unsigned getModelHitNum() const {
+			return modelHits;
+		}
+		inline unsigned getCoreHitNum() const {
+			return coreHits;
+		}
+		inline unsigned getMissNum() const {
+			return misses;
+		}
+		inline unsigned getCoreNum() const {
+			return cores.size();
+		}
+		///@}
+
+	 private:
+		struct Entry {
+			z3::model model;
+			std::unordered_map<unsigned, std::pair<z3::expr, bool>> evaluated;	///< AST id -> (constraint, holds under model)
+		};
+
+		/// Evaluate e under the model of entry, with model completion (the model of a smaller query may miss symbols)
+		inline bool holds(Entry& entry, const z3::expr& e) {
+			auto it = entry.evaluated.find(e.id());
+			if (it != entry.evaluated.end())
+				return it->second.second;
+			bool res = entry.model.eval(e, true).is_true();
+			entry.evaluated.emplace(e.id(), std::make_pair(e, res));
+			return res;
+		}
+
+		std::deque<Entry> models;	///< most recently used first
+		std::vector<Core> cores;
+		std::unordered_map<unsigned, std::vector<unsigned>> byConstraint;	///< AST id -> cores containing it
+		std::unordered_map<unsigned, z3::expr> pinned;	///< keeps the constraints of the cores (and so their ids) alive
+		unsigned modelCapacity;
+		unsigned coreCapacity;
+		unsigned modelHits;
+		unsigned coreHits;
+		unsigned misses;
+	};
+
+} // namespace SVF
+
+#endif // SOFTWARE_SECURITY_ANALYSIS_Z3MODELCACHE_H